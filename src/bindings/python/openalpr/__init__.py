@@ -1,6 +1,6 @@
 import sys as _sys
 
 if _sys.version_info.major >= 3:
-    from .openalpr import Alpr
+    from .openalpr import Alpr, decode_results
 else:
-    from openalpr import Alpr
\ No newline at end of file
+    from openalpr import Alpr, decode_results
\ No newline at end of file
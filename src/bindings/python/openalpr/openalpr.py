@@ -1,6 +1,7 @@
 import ctypes
 import json
 import platform
+import struct
 
 # We need to do things slightly differently for Python 2 vs. 3
 # ... because the way str/unicode have changed to bytes/str
@@ -32,6 +33,161 @@ def _convert_from_charp(charp):
         return charp
 
 
+class _BinaryRecordReader:
+    # Reads the fields of the binary results records written by alprd (see binary_results.h)
+
+    def __init__(self, data, position, end):
+        self.data = data
+        self.position = position
+        self.end = end
+
+    def read_byte(self):
+        if self.position >= self.end:
+            raise ValueError("Truncated binary results record")
+        value = self.data[self.position]
+        self.position += 1
+        return value
+
+    def read_int(self):
+        encoded = 0
+        shift = 0
+        while True:
+            byte = self.read_byte()
+            encoded |= (byte & 0x7F) << shift
+            if byte & 0x80 == 0:
+                return (encoded >> 1) ^ -(encoded & 1)
+            shift += 7
+            if shift >= 64:
+                raise ValueError("Invalid integer in binary results record")
+
+    def read_count(self):
+        count = self.read_int()
+        if count < 0 or count > self.end - self.position:
+            raise ValueError("Invalid count in binary results record")
+        return count
+
+    def read_float(self):
+        if self.position + 4 > self.end:
+            raise ValueError("Truncated binary results record")
+        value = struct.unpack_from("<f", bytes(self.data[self.position:self.position + 4]))[0]
+        self.position += 4
+        return value
+
+    def read_string(self):
+        length = self.read_count()
+        value = bytes(self.data[self.position:self.position + length]).decode("UTF-8")
+        self.position += length
+        return value
+
+    def read_plate(self):
+        plate = {}
+        plate['plate'] = self.read_string()
+        plate['confidence'] = self.read_float()
+        plate['matches_template'] = self.read_byte()
+        return plate
+
+    def read_plate_result(self):
+        result = {}
+        result['plate_index'] = self.read_int()
+        result['region_confidence'] = self.read_int()
+        result['region'] = self.read_string()
+        result['processing_time_ms'] = self.read_float()
+        result['requested_topn'] = self.read_int()
+        result['coordinates'] = []
+        for i in range(4):
+            x = self.read_int()
+            y = self.read_int()
+            result['coordinates'].append({'x': x, 'y': y})
+        result['candidates'] = [self.read_plate() for i in range(self.read_count())]
+
+        if self.read_byte() and len(result['candidates']) > 0:
+            best = result['candidates'][0]
+        else:
+            best = self.read_plate()
+        result['plate'] = best['plate']
+        result['confidence'] = best['confidence']
+        result['matches_template'] = best['matches_template']
+        return result
+
+    def read_results(self):
+        results = {'version': 2, 'data_type': 'alpr_results'}
+        results['epoch_time'] = self.read_int()
+        frame_number = self.read_int()
+        results['img_width'] = self.read_int()
+        results['img_height'] = self.read_int()
+        results['processing_time_ms'] = self.read_float()
+        if frame_number >= 0:
+            results['frame_number'] = frame_number
+
+        results['regions_of_interest'] = []
+        for i in range(self.read_count()):
+            x = self.read_int()
+            y = self.read_int()
+            width = self.read_int()
+            height = self.read_int()
+            results['regions_of_interest'].append({'x': x, 'y': y, 'width': width, 'height': height})
+
+        results['results'] = [self.read_plate_result() for i in range(self.read_count())]
+
+        stage_count = self.read_count()
+        if stage_count > 0:
+            results['stage_times_ms'] = {}
+            for i in range(stage_count):
+                stage = self.read_string()
+                results['stage_times_ms'][stage] = self.read_float()
+        return results
+
+
+def decode_results(data):
+    """
+    Decodes the binary results records that alprd writes when result_format = binary.
+
+    :param data: One or more concatenated records, as a string (Python 2) or bytes object (Python 3)
+    :return: A list of response dictionaries, one per record, in the same form as the JSON results
+    """
+    data = bytearray(data)
+    records = []
+    position = 0
+    while position < len(data):
+        if position + 4 > len(data):
+            raise ValueError("Truncated binary results record")
+        length = struct.unpack_from("<I", bytes(data[position:position + 4]))[0]
+        end = position + 4 + length
+        if end > len(data) or length < 6 or bytes(data[position + 4:position + 8]) != b"ALPR":
+            raise ValueError("Invalid binary results record")
+
+        reader = _BinaryRecordReader(data, position + 8, end)
+        version = reader.read_byte()
+        record_type = reader.read_byte()
+        if version != 1:
+            raise ValueError("Unsupported binary results version: %d" % version)
+
+        if record_type == 1:
+            record = reader.read_results()
+        elif record_type == 2:
+            record = reader.read_plate_result()
+        else:
+            raise ValueError("Unknown binary results record type: %d" % record_type)
+
+        # Extra fields (uuid, camera_id, etc.) go at the top level, as they do in the JSON
+        while True:
+            kind = reader.read_byte()
+            if kind == 0:
+                break
+            name = reader.read_string()
+            if kind == 1:
+                record[name] = reader.read_string()
+            elif kind == 2:
+                record[name] = reader.read_int()
+            else:
+                raise ValueError("Unknown field kind in binary results record: %d" % kind)
+
+        records.append(record)
+        position = end
+
+    return records
+
+
 class Alpr:
     def __init__(self, country, config_file, runtime_dir):
         """
@@ -79,6 +235,11 @@ class Alpr:
         self._recognize_array_func.restype = ctypes.c_void_p
         self._recognize_array_func.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_ubyte), ctypes.c_uint]
 
+        self._recognize_array_batch_func = self._openalprpy_lib.recognizeArrayBatch
+        self._recognize_array_batch_func.restype = ctypes.c_void_p
+        self._recognize_array_batch_func.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.POINTER(ctypes.c_ubyte)),
+                                                     ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+
         try:
             import numpy as np
             import numpy.ctypeslib as npct
@@ -170,6 +331,29 @@ class Alpr:
         self._free_json_mem_func(ctypes.c_void_p(ptr))
         return response_obj
 
+    def recognize_array_batch(self, byte_arrays):
+        """
+        This causes OpenALPR to recognize a list of images passed in as byte arrays.  The
+        images are analyzed concurrently when plate_analysis_threads is greater than 1.
+
+        :param byte_arrays: A list of strings (Python 2) or bytes objects (Python 3)
+        :return: A list of OpenALPR response dictionaries, one per image and in the same order
+        """
+        count = len(byte_arrays)
+        buffers = (ctypes.POINTER(ctypes.c_ubyte) * count)()
+        lengths = (ctypes.c_int * count)()
+        for i, byte_array in enumerate(byte_arrays):
+            if type(byte_array) != bytes:
+                raise TypeError("Expected a list of byte arrays (strings in Python 2, bytes in Python 3)")
+            buffers[i] = ctypes.cast(byte_array, ctypes.POINTER(ctypes.c_ubyte))
+            lengths[i] = len(byte_array)
+        ptr = self._recognize_array_batch_func(self.alpr_pointer, buffers, lengths, count)
+        json_data = ctypes.cast(ptr, ctypes.c_char_p).value
+        json_data = _convert_from_charp(json_data)
+        response_obj = json.loads(json_data)
+        self._free_json_mem_func(ctypes.c_void_p(ptr))
+        return response_obj
+
     def recognize_ndarray(self, ndarray):
         """
         This causes OpenALPR to attempt to recognize an image passed in as a numpy array.
@@ -96,6 +96,31 @@ extern "C" {
       return membuffer;
     }
 
+  OPENALPR_EXPORT char* recognizeArrayBatch(Alpr* nativeAlpr, unsigned char** bufs, int* lens, int count)
+    {
+      std::vector<std::vector<char> > batch;
+      for (int i = 0; i < count; i++)
+        batch.push_back(std::vector<char>(bufs[i], bufs[i] + lens[i]));
+
+      std::vector<AlprResults> results = nativeAlpr->recognizeBatch(batch);
+
+      // Respond with a JSON array, one entry per image
+      std::string json = "[";
+      for (unsigned int i = 0; i < results.size(); i++)
+      {
+        if (i > 0)
+          json += ",";
+        json += Alpr::toJson(results[i]);
+      }
+      json += "]";
+
+      int strsize = sizeof(char) * (strlen(json.c_str()) + 1);
+      char* membuffer = (char*)malloc(strsize);
+      strcpy(membuffer, json.c_str());
+
+      return membuffer;
+    }
+
   // AlprResults recognize(unsigned char* pixelData,
   // int bytesPerPixel, int imgWidth, int imgHeight,
   // std::vector<AlprRegionOfInterest> regionsOfInterest);
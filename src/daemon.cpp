@@ -7,11 +7,15 @@
 #include "daemon/beanstalk.hpp"
 #include "video/logging_videobuffer.h"
 #include "daemon/daemonconfig.h"
-#include "inc/safequeue.h"
+#include "inc/boundedqueue.h"
+#include "motiondetector.h"
+#include "plate_tracker.h"
+#include "detection_scheduler.h"
 
 #include "tclap/CmdLine.h"
 #include "alpr.h"
-#include "openalpr/cjson.h"
+#include "json_writer.h"
+#include "binary_results.h"
 #include "support/tinythread.h"
 #include <curl/curl.h>
 #include "support/timing.h"
@@ -24,13 +28,13 @@
 
 using namespace alpr;
 
-// Variables
-SafeQueue<cv::Mat> framesQueue;
-
 // Prototypes
 void streamRecognitionThread(void* arg);
+QueueFullPolicy parseQueuePolicy(std::string policy);
+bool parseResultFormat(std::string format);
 bool writeToQueue(std::string jsonResult);
-bool uploadPost(CURL* curl, std::string url, std::string data);
+void writeGroupsToQueue(std::vector<PlateGroup> groups, void* arg);
+bool uploadPost(CURL* curl, std::string url, std::string data, bool binary);
 void dataUploadThread(void* arg);
 
 // Constants
@@ -38,11 +42,25 @@ const std::string ALPRD_CONFIG_FILE_NAME="alprd.conf";
 const std::string OPENALPR_CONFIG_FILE_NAME="openalpr.conf";
 const std::string DEFAULT_LOG_FILE_PATH="/var/log/alprd.log";
 
+// How often each camera logs its frame pool and frame queue usage
+const double FRAME_STATS_INTERVAL_MS = 60000;
+
+// Frames are downscaled to this width for motion detection
+const int MOTION_DETECTION_WIDTH = 320;
+
 const std::string BEANSTALK_QUEUE_HOST="127.0.0.1";
 const int BEANSTALK_PORT=11300;
 const std::string BEANSTALK_TUBE_NAME="alprd";
 
 
+// A frame waiting to be analyzed, along with the areas of it to search for plates
+struct QueuedFrame
+{
+  cv::Mat frame;
+  std::vector<AlprRegionOfInterest> regionsOfInterest;
+  int64_t capture_time;
+};
+
 struct CaptureThreadData
 {
   std::string company_id;
@@ -51,6 +69,18 @@ struct CaptureThreadData
   int camera_id;
   int analysis_threads;
   
+  // Frames captured from this camera, waiting for an analysis thread
+  BoundedQueue<QueuedFrame>* frames_queue;
+  
+  bool motion_detection;
+  
+  // Consolidates plates across frames.  NULL unless plate tracking is enabled
+  PlateTracker* plate_tracker;
+  int plate_tracking_timeout;
+  
+  // Picks the parts of each frame to search.  NULL unless detection_schedule is set in openalpr.conf
+  DetectionScheduler* detection_scheduler;
+  
   bool clock_on;
   
   std::string config_file;
@@ -59,6 +89,9 @@ struct CaptureThreadData
   bool output_images;
   std::string output_image_folder;
   int top_n;
+
+  // Results go on the queue as binary records (binary_results.h) rather than JSON
+  bool binary_results;
 };
 
 struct UploadThreadData
@@ -66,6 +99,9 @@ struct UploadThreadData
   std::string upload_url;
 };
 
+// The most queued binary records sent in one upload
+const unsigned int UPLOAD_BATCH_SIZE = 50;
+
 void segfault_handler(int sig) {
   void *array[10];
   size_t size;
@@ -206,9 +242,19 @@ int main( int argc, const char** argv )
       tdata->company_id = daemon_config.company_id;
       tdata->site_id = daemon_config.site_id;
       tdata->analysis_threads = daemon_config.analysis_threads;
+      tdata->frames_queue = new BoundedQueue<QueuedFrame>(daemon_config.frame_queue_size, 
+                                                         parseQueuePolicy(daemon_config.frame_queue_policy));
+      tdata->motion_detection = daemon_config.motion_detection;
+      tdata->plate_tracker = NULL;
+      tdata->detection_scheduler = NULL;
+      if (daemon_config.plate_tracking)
+        tdata->plate_tracking_timeout = daemon_config.plate_tracking_timeout;
+      else
+        tdata->plate_tracking_timeout = 0;
       tdata->top_n = daemon_config.topn;
       tdata->pattern = daemon_config.pattern;
       tdata->clock_on = clockOn;
+      tdata->binary_results = parseResultFormat(daemon_config.result_format);
       
       tthread::thread* thread_recognize = new tthread::thread(streamRecognitionThread, (void*) tdata);
       threads.push_back(thread_recognize);
@@ -237,6 +283,30 @@ int main( int argc, const char** argv )
   return 0;
 }
 
+// Adds the fields that say where a result came from.  Writer is a JsonWriter or a BinaryWriter
+template <class Writer>
+void addSourceFields(Writer* writer, CaptureThreadData* tdata, std::string uuid)
+{
+  writer->addField("uuid", uuid);
+  writer->addField("camera_id", tdata->camera_id);
+  writer->addField("site_id", tdata->site_id);
+
+  // Add the company ID to the output if configured
+  if (tdata->company_id.length() > 0)
+    writer->addField("company_id", tdata->company_id);
+}
+
+template <class Writer>
+void addGroupFields(Writer* writer, const PlateGroup& group, CaptureThreadData* tdata)
+{
+  writer->addField("data_type", "alpr_group");
+  writer->addField("group_id", group.group_id);
+  writer->addField("epoch_start", group.start_time);
+  writer->addField("epoch_end", group.end_time);
+  writer->addField("frame_count", group.frame_count);
+  addSourceFields(writer, tdata, group.best_frame_tag);
+}
+
 
 void processingThread(void* arg)
 {
@@ -245,19 +315,28 @@ void processingThread(void* arg)
   alpr.setTopN(tdata->top_n);
   alpr.setDefaultRegion(tdata->pattern);
 
-  while (daemon_active) {
+  QueuedFrame queued;
 
-    // Wait for a new frame
-    cv::Mat frame = framesQueue.pop();
+  // Reused for every frame, so the output buffers only grow
+  JsonWriter json_writer;
+  BinaryWriter binary_writer;
+  
+  timespec lastStatsTime;
+  getTimeMonotonic(&lastStatsTime);
+  
+  // Sleeps until a frame arrives.  Fails once the camera shuts down
+  while (tdata->frames_queue->pop(&queued)) {
+
+    cv::Mat frame = queued.frame;
 
     // Process new frame
     timespec startTime;
     getTimeMonotonic(&startTime);
 
-    std::vector<AlprRegionOfInterest> regionsOfInterest;
-    regionsOfInterest.push_back(AlprRegionOfInterest(0,0, frame.cols, frame.rows));
+    AlprResults results = alpr.recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, queued.regionsOfInterest);
 
-    AlprResults results = alpr.recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, regionsOfInterest);
+    if (tdata->detection_scheduler != NULL)
+      tdata->detection_scheduler->addResults(results, queued.capture_time);
 
     timespec endTime;
     getTimeMonotonic(&endTime);
@@ -267,6 +346,13 @@ void processingThread(void* arg)
       LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " processed frame in: " << totalProcessingTime << " ms.");
     }
 
+    if (diffclock(lastStatsTime, endTime) >= FRAME_STATS_INTERVAL_MS)
+    {
+      // Stage timing histograms, plate counts and rejections since the thread started
+      LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " recognition stats: " << Alpr::toJson(alpr.getStats()));
+      lastStatsTime = endTime;
+    }
+
     if (results.plates.size() > 0) {
 
       std::stringstream uuid_ss;
@@ -280,36 +366,40 @@ void processingThread(void* arg)
         cv::imwrite(ss.str(), frame);
       }
 
-      // Update the JSON content to include UUID and camera ID
-      std::string json = alpr.toJson(results);
-      cJSON *root = cJSON_Parse(json.c_str());
-      cJSON_AddStringToObject(root,	"uuid",		uuid.c_str());
-      cJSON_AddNumberToObject(root,	"camera_id",	tdata->camera_id);
-      cJSON_AddStringToObject(root, 	"site_id", 	tdata->site_id.c_str());
-      cJSON_AddNumberToObject(root,	"img_width",	frame.cols);
-      cJSON_AddNumberToObject(root,	"img_height",	frame.rows);
-
-      // Add the company ID to the output if configured
-      if (tdata->company_id.length() > 0)
-        cJSON_AddStringToObject(root, 	"company_id", 	tdata->company_id.c_str());
-
-      char *out;
-      out=cJSON_PrintUnformatted(root);
-      cJSON_Delete(root);
-
-      std::string response(out);
-
-      free(out);
+      if (tdata->plate_tracker != NULL)
+      {
+        // Plates are reported once their track ends, rather than for every frame
+        std::vector<PlateGroup> groups = tdata->plate_tracker->addFrame(results, queued.capture_time, uuid);
+        writeGroupsToQueue(groups, tdata);
+        continue;
+      }
 
-      // Push the results to the Beanstalk queue
       for (int j = 0; j < results.plates.size(); j++)
       {
         LOG4CPLUS_DEBUG(logger, "Writing plate " << results.plates[j].bestPlate.characters << " (" <<  uuid << ") to queue.");
       }
 
-      writeToQueue(response);
+      // Push the results, along with the UUID and camera ID, to the Beanstalk queue
+      if (tdata->binary_results)
+      {
+        binary_writer.clear();
+        binary_writer.beginRecord(results);
+        addSourceFields(&binary_writer, tdata, uuid);
+        binary_writer.endRecord();
+
+        writeToQueue(binary_writer.str());
+      }
+      else
+      {
+        json_writer.clear();
+        json_writer.beginObject();
+        json_writer.addResultsFields(results);
+        addSourceFields(&json_writer, tdata, uuid);
+        json_writer.endObject();
+
+        writeToQueue(json_writer.str());
+      }
     }
-    usleep(10000);
   }
 }
 
@@ -322,6 +412,13 @@ void streamRecognitionThread(void* arg)
   LOG4CPLUS_INFO(logger, "pattern: " << tdata->pattern);
   LOG4CPLUS_INFO(logger, "Stream " << tdata->camera_id << ": " << tdata->stream_url);
   
+  // The tracker and scheduler must exist before the processing threads start using them
+  Config camera_config(tdata->country_code, tdata->config_file);
+  if (tdata->plate_tracking_timeout > 0)
+    tdata->plate_tracker = new PlateTracker(&camera_config, tdata->top_n, tdata->plate_tracking_timeout);
+  if (camera_config.detectionSchedule)
+    tdata->detection_scheduler = new DetectionScheduler(&camera_config);
+  
   /* Create processing threads */
   const int num_threads = tdata->analysis_threads;
   tthread::thread* threads[num_threads];
@@ -332,31 +429,166 @@ void streamRecognitionThread(void* arg)
       threads[i] = t;
   }
   
+  // Every queued frame and every frame being analyzed holds a pooled buffer, as do the video
+  // buffer's newest frame and the one it's decoding into
+  int frame_pool_size = tdata->frames_queue->getStats().capacity + num_threads + 2;
+  
   cv::Mat frame;
   LoggingVideoBuffer videoBuffer(logger);
-  videoBuffer.connect(tdata->stream_url, 5);
+  videoBuffer.connect(tdata->stream_url, 5, frame_pool_size);
   LOG4CPLUS_INFO(logger, "Starting camera " << tdata->camera_id);
   
+  MotionDetector motionDetector(MOTION_DETECTION_WIDTH);
+  long framesWithoutMotion = 0;
+  
+  timespec lastStatsTime;
+  getTimeMonotonic(&lastStatsTime);
+  
   while (daemon_active)
   {
     std::vector<cv::Rect> regionsOfInterest;
     int response = videoBuffer.getLatestFrame(&frame, regionsOfInterest);
     
     if (response != -1) {
-      if (framesQueue.empty()) {
-        framesQueue.push(frame.clone());
+      // The frame shares the video buffer's pooled memory.  The processing threads only read it
+      QueuedFrame queued;
+      queued.frame = frame;
+      queued.capture_time = getEpochTimeMs();
+      
+      std::vector<cv::Rect> searchRegions;
+      if (tdata->motion_detection)
+      {
+        // Search each moving area separately, and skip the frame entirely if nothing moved.
+        // This runs on every frame, since the background model depends on seeing all of them
+        searchRegions = motionDetector.MotionDetectRegions(frame);
       }
+      else if (tdata->detection_scheduler != NULL)
+      {
+        searchRegions = tdata->detection_scheduler->nextRegions(queued.capture_time, frame.cols, frame.rows);
+      }
+      else
+      {
+        searchRegions.push_back(cv::Rect(0, 0, frame.cols, frame.rows));
+      }
+
+      // Also search around the plates being tracked, since that's where they'll be.  This adds to the
+      // areas above rather than replacing them, so a plate entering elsewhere in the frame is still found
+      if (tdata->plate_tracker != NULL)
+        searchRegions = tdata->plate_tracker->addTrackedRegions(searchRegions, queued.capture_time, frame.cols, frame.rows);
+
+      for (unsigned int i = 0; i < searchRegions.size(); i++)
+      {
+        cv::Rect r = searchRegions[i];
+        queued.regionsOfInterest.push_back(AlprRegionOfInterest(r.x, r.y, r.width, r.height));
+      }
+      
+      if (queued.regionsOfInterest.size() > 0)
+        tdata->frames_queue->push(queued);
+      else
+        framesWithoutMotion++;
     }
     
+    // Report the plates that have left the scene, even if no frames have been analyzed lately
+    if (tdata->plate_tracker != NULL)
+      writeGroupsToQueue(tdata->plate_tracker->expireTracks(getEpochTimeMs()), tdata);
+    
+    timespec now;
+    getTimeMonotonic(&now);
+    if (diffclock(lastStatsTime, now) >= FRAME_STATS_INTERVAL_MS)
+    {
+      FramePoolStats stats = videoBuffer.getFramePoolStats();
+      LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " frame pool: " << stats.buffers_in_use << "/" << stats.buffers << " buffers in use, " <<
+                     stats.frames_reused << " frames reused, " << stats.frames_allocated << " allocated, " << stats.frames_overflowed << " overflowed");
+      
+      BoundedQueueStats queue_stats = tdata->frames_queue->getStats();
+      LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " frame queue: " << queue_stats.depth << "/" << queue_stats.capacity << " frames waiting, " <<
+                     queue_stats.pushed << " queued, " << queue_stats.dropped << " dropped");
+      if (tdata->motion_detection)
+        LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " skipped " << framesWithoutMotion << " frames without motion");
+      lastStatsTime = now;
+    }
+    
+    // Only checks for a new frame.  The analysis threads wait on the queue
     usleep(10000);
   }
   
   videoBuffer.disconnect();
-  LOG4CPLUS_INFO(logger, "Video processing ended");
-  delete tdata;
+  
+  // Wake up the processing threads so they can exit
+  tdata->frames_queue->close();
   for (int i = 0; i < num_threads; i++) {
+    threads[i]->join();
     delete threads[i];
   }
+  
+  if (tdata->plate_tracker != NULL)
+  {
+    writeGroupsToQueue(tdata->plate_tracker->flush(), tdata);
+    delete tdata->plate_tracker;
+  }
+  
+  delete tdata->detection_scheduler;
+  
+  LOG4CPLUS_INFO(logger, "Video processing ended");
+  delete tdata->frames_queue;
+  delete tdata;
+}
+
+// Sends one result per tracked plate.  The uuid is the frame where the plate was read best
+void writeGroupsToQueue(std::vector<PlateGroup> groups, void* arg)
+{
+  CaptureThreadData* tdata = (CaptureThreadData*) arg;
+
+  JsonWriter json_writer;
+  BinaryWriter binary_writer;
+  for (unsigned int i = 0; i < groups.size(); i++)
+  {
+    LOG4CPLUS_DEBUG(logger, "Writing plate group " << groups[i].plate.bestPlate.characters << " (" << groups[i].frame_count << 
+                    " frames, " << groups[i].best_frame_tag << ") to queue.");
+
+    if (tdata->binary_results)
+    {
+      binary_writer.clear();
+      binary_writer.beginRecord(groups[i].plate);
+      addGroupFields(&binary_writer, groups[i], tdata);
+      binary_writer.endRecord();
+
+      writeToQueue(binary_writer.str());
+    }
+    else
+    {
+      json_writer.clear();
+      json_writer.beginObject();
+      json_writer.addPlateResultFields(groups[i].plate);
+      addGroupFields(&json_writer, groups[i], tdata);
+      json_writer.endObject();
+
+      writeToQueue(json_writer.str());
+    }
+  }
+}
+
+// True for binary results, false for JSON
+bool parseResultFormat(std::string format)
+{
+  if (format == "binary")
+    return true;
+  else if (format != "json")
+    LOG4CPLUS_WARN(logger, "Unknown result_format: " << format << ".  Using json");
+
+  return false;
+}
+
+QueueFullPolicy parseQueuePolicy(std::string policy)
+{
+  if (policy == "latest_only")
+    return QUEUE_LATEST_ONLY;
+  else if (policy == "block")
+    return QUEUE_BLOCK;
+  else if (policy != "drop_oldest")
+    LOG4CPLUS_WARN(logger, "Unknown frame_queue_policy: " << policy << ".  Using drop_oldest");
+  
+  return QUEUE_DROP_OLDEST;
 }
 
 
@@ -420,18 +652,50 @@ void dataUploadThread(void* arg)
 	
 	if (job.id() > 0)
 	{
+	  std::vector<Beanstalk::Job> jobs;
+	  jobs.push_back(job);
+	  std::string body = job.body();
+
+	  // The queue may hold JSON jobs as well as binary ones (e.g., queued before result_format was
+	  // changed), so each job's format is checked.  JSON jobs are sent on their own
+	  bool binary = isBinaryRecords(body);
+
+	  // Binary records carry their own length, so the binary jobs that are already waiting can share one upload
+	  if (binary)
+	  {
+	    Beanstalk::Job waiting_job;
+	    while (jobs.size() < UPLOAD_BATCH_SIZE && client.reserve(waiting_job, 0) && waiting_job.id() > 0)
+	    {
+	      if (!isBinaryRecords(waiting_job.body()))
+	      {
+		// Put it back for the next upload
+		client.release(waiting_job);
+		break;
+	      }
+
+	      jobs.push_back(waiting_job);
+	      body += waiting_job.body();
+	    }
+	  }
+
 	  //LOG4CPLUS_DEBUG(logger, job.body() );
-	  if (uploadPost(curl, udata->upload_url, job.body()))
+	  if (uploadPost(curl, udata->upload_url, body, binary))
 	  {
-	    client.del(job.id());
-	    LOG4CPLUS_INFO(logger, "Job: " << job.id() << " successfully uploaded" );
+	    for (unsigned int j = 0; j < jobs.size(); j++)
+	    {
+	      client.del(jobs[j].id());
+	      LOG4CPLUS_INFO(logger, "Job: " << jobs[j].id() << " successfully uploaded" );
+	    }
 	    // Wait 10ms
 	    sleep_ms(10);
 	  }
 	  else
 	  {
-	    client.release(job);
-	    LOG4CPLUS_WARN(logger, "Job: " << job.id() << " failed to upload.  Will retry." );
+	    for (unsigned int j = 0; j < jobs.size(); j++)
+	    {
+	      client.release(jobs[j]);
+	      LOG4CPLUS_WARN(logger, "Job: " << jobs[j].id() << " failed to upload.  Will retry." );
+	    }
 	    // Wait 2 seconds
 	    sleep_ms(2000);
 	  }
@@ -454,7 +718,7 @@ void dataUploadThread(void* arg)
 }
 
 
-bool uploadPost(CURL* curl, std::string url, std::string data)
+bool uploadPost(CURL* curl, std::string url, std::string data, bool binary)
 {
   bool success = true;
   CURLcode res;
@@ -462,8 +726,15 @@ bool uploadPost(CURL* curl, std::string url, std::string data)
 
   /* Add the required headers */ 
   headers = curl_slist_append(headers,  "Accept: application/json");
-  headers = curl_slist_append( headers, "Content-Type: application/json");
-  headers = curl_slist_append( headers, "charsets: utf-8");
+  if (binary)
+  {
+    headers = curl_slist_append( headers, "Content-Type: application/octet-stream");
+  }
+  else
+  {
+    headers = curl_slist_append( headers, "Content-Type: application/json");
+    headers = curl_slist_append( headers, "charsets: utf-8");
+  }
  
   if(curl) {
 	/* Add the headers */
@@ -476,6 +747,7 @@ bool uploadPost(CURL* curl, std::string url, std::string data)
     /* Now specify the POST data */ 
     //char* escaped_data = curl_easy_escape(curl, data.c_str(), data.length());
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) data.size());
     //curl_free(escaped_data);
  
     /* Perform the request, res will get the return code */ 
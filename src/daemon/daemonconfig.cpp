@@ -47,11 +47,17 @@ DaemonConfig::DaemonConfig(std::string config_file, std::string config_defaults_
   country = getString(&ini, &defaultIni, "daemon", "country", "us");
   topn = getInt(&ini, &defaultIni, "daemon", "topn", 20);
   analysis_threads = getInt(&ini, &defaultIni, "daemon", "analysis_threads", 1);
+  frame_queue_size = getInt(&ini, &defaultIni, "daemon", "frame_queue_size", 4);
+  frame_queue_policy = getString(&ini, &defaultIni, "daemon", "frame_queue_policy", "drop_oldest");
+  motion_detection = getBoolean(&ini, &defaultIni, "daemon", "motion_detection", false);
+  plate_tracking = getBoolean(&ini, &defaultIni, "daemon", "plate_tracking", false);
+  plate_tracking_timeout = getInt(&ini, &defaultIni, "daemon", "plate_tracking_timeout", 1500);
   
   storePlates = getBoolean(&ini, &defaultIni, "daemon", "store_plates", false);
   imageFolder = getString(&ini, &defaultIni, "daemon", "store_plates_location", "/tmp/");
   uploadData = getBoolean(&ini, &defaultIni, "daemon", "upload_data", false);
   upload_url = getString(&ini, &defaultIni, "daemon", "upload_address", "");
+  result_format = getString(&ini, &defaultIni, "daemon", "result_format", "json");
   company_id = getString(&ini, &defaultIni, "daemon", "company_id", "");
   site_id = getString(&ini, &defaultIni, "daemon", "site_id", "");
   pattern = getString(&ini, &defaultIni, "daemon", "pattern", "");
@@ -17,10 +17,16 @@ public:
   
   int topn;
   int analysis_threads;
+  int frame_queue_size;
+  std::string frame_queue_policy;
+  bool motion_detection;
+  bool plate_tracking;
+  int plate_tracking_timeout;
   bool storePlates;
   std::string imageFolder;
   bool uploadData;
   std::string upload_url;
+  std::string result_format;
   std::string company_id;
   std::string site_id;
   std::string pattern;
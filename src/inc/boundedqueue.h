@@ -0,0 +1,121 @@
+#ifndef BOUNDED_QUEUE_H_
+#define BOUNDED_QUEUE_H_
+
+#include <deque>
+#include "support/tinythread.h"
+
+// What push() does when the queue is already at capacity
+enum QueueFullPolicy
+{
+    QUEUE_LATEST_ONLY,  // Hold a single item.  A new item replaces the one waiting
+    QUEUE_DROP_OLDEST,  // Discard the oldest waiting item to make room
+    QUEUE_BLOCK         // Wait until a consumer makes room
+};
+
+struct BoundedQueueStats
+{
+    int depth;
+    int capacity;
+    long pushed;
+    long dropped;
+};
+
+// Fixed-capacity FIFO shared by one producer and any number of consumers.
+// Consumers sleep on a condition variable until an item arrives or the queue is closed.
+template <typename T>
+class BoundedQueue
+{
+    public:
+        BoundedQueue(int capacity, QueueFullPolicy policy)
+        {
+            if (policy == QUEUE_LATEST_ONLY || capacity < 1)
+                capacity = 1;
+
+            _capacity = capacity;
+            _policy = policy;
+            _closed = false;
+            _pushed = 0;
+            _dropped = 0;
+        }
+
+        // Returns false if the queue was closed before the item could be added
+        bool push(const T& item)
+        {
+            tthread::lock_guard<tthread::mutex> mlock(_mutex);
+
+            if (_policy == QUEUE_BLOCK)
+            {
+                while (!_closed && (int) _queue.size() >= _capacity)
+                    _notFull.wait(_mutex);
+            }
+            else
+            {
+                while ((int) _queue.size() >= _capacity)
+                {
+                    _queue.pop_front();
+                    _dropped++;
+                }
+            }
+
+            if (_closed)
+                return false;
+
+            _queue.push_back(item);
+            _pushed++;
+            _notEmpty.notify_one();
+            return true;
+        }
+
+        // Waits for the next item.  Returns false once the queue is closed
+        bool pop(T* item)
+        {
+            tthread::lock_guard<tthread::mutex> mlock(_mutex);
+            while (!_closed && _queue.empty())
+                _notEmpty.wait(_mutex);
+
+            if (_closed)
+                return false;
+
+            *item = _queue.front();
+            _queue.pop_front();
+            _notFull.notify_one();
+            return true;
+        }
+
+        // Wakes every waiting producer and consumer.  Items still queued are discarded
+        void close()
+        {
+            tthread::lock_guard<tthread::mutex> mlock(_mutex);
+            _closed = true;
+            _queue.clear();
+            _notEmpty.notify_all();
+            _notFull.notify_all();
+        }
+
+        BoundedQueueStats getStats()
+        {
+            tthread::lock_guard<tthread::mutex> mlock(_mutex);
+
+            BoundedQueueStats stats;
+            stats.depth = _queue.size();
+            stats.capacity = _capacity;
+            stats.pushed = _pushed;
+            stats.dropped = _dropped;
+            return stats;
+        }
+
+    private:
+        std::deque<T> _queue;
+        int _capacity;
+        QueueFullPolicy _policy;
+        bool _closed;
+
+        long _pushed;
+        long _dropped;
+
+        tthread::mutex _mutex;
+        tthread::condition_variable _notEmpty;
+        tthread::condition_variable _notFull;
+};
+
+#endif
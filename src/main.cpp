@@ -20,8 +20,10 @@
 #include <cstdio>
 #include <sstream>
 #include <iostream>
+#include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <map>
 
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
@@ -30,8 +32,11 @@
 #include "support/filesystem.h"
 #include "support/timing.h"
 #include "support/platform.h"
+#include "support/tinythread.h"
+#include "inc/boundedqueue.h"
 #include "video/videobuffer.h"
 #include "motiondetector.h"
+#include "json_writer.h"
 #include "alpr.h"
 
 using namespace alpr;
@@ -44,8 +49,98 @@ const std::string WEBCAM_PREFIX = "/dev/video";
 MotionDetector motiondetector;
 bool do_motiondetection = true;
 
+// A decoded video frame on its way through the recognizers.  A frame number of -1 tells the worker to stop
+struct VideoFrame
+{
+  int framenum;
+  double frameTime;
+  double vidFrame;
+  cv::Mat frame;
+  std::vector<AlprRegionOfInterest> regionsOfInterest;
+
+  AlprResults results;
+  double processingTime;
+
+  // Set when recognizing the frame threw.  The frame is skipped when the results are printed
+  bool failed;
+};
+
+// State shared by the decode thread, the recognizer threads and the thread printing the results
+struct VideoPipeline
+{
+  cv::VideoCapture* cap;
+  int endatms;
+  std::vector<int> regionCoords;
+  int num_workers;
+
+  BoundedQueue<VideoFrame>* frames_queue;
+
+  tthread::mutex mutex;
+  tthread::condition_variable frame_finished;
+
+  // Recognized frames that can't be printed until the frames before them are done
+  std::map<int, VideoFrame> finished;
+  int frames_decoded;
+  bool decoding_done;
+};
+
+struct VideoWorker
+{
+  VideoPipeline* pipeline;
+  Alpr* alpr;
+};
+
+// An image listed for bulk processing.  An index of -1 tells the worker to stop
+struct BulkImage
+{
+  int64_t index;
+  std::string filename;
+};
+
+// State shared by the thread listing the images, the recognizer threads and the thread writing the results
+struct BulkPipeline
+{
+  std::vector<std::string> inputs;
+  int64_t start_offset;
+  std::vector<int> regionCoords;
+  int num_workers;
+
+  BoundedQueue<BulkImage>* images_queue;
+
+  tthread::mutex mutex;
+  tthread::condition_variable image_finished;
+
+  // JSON lines that can't be written until the images listed before them are done
+  std::map<int64_t, std::string> finished;
+  int64_t images_listed;
+  bool listing_done;
+};
+
+struct BulkWorker
+{
+  BulkPipeline* pipeline;
+  Alpr* alpr;
+
+  // Reused for every image the worker recognizes
+  JsonWriter writer;
+};
+
+// How many images are written between checkpoint updates
+const int BULK_CHECKPOINT_INTERVAL = 100;
+
 /** Function Headers */
-bool detectandshow(Alpr* alpr, cv::Mat frame, std::string region, bool writeJson, std::vector<int> regionCoords);
+bool detectandshow(Alpr* alpr, cv::Mat frame, std::string region, bool writeJson, std::vector<int> regionCoords, int64_t frame_number = -1);
+std::vector<AlprRegionOfInterest> getRegionsOfInterest(cv::Mat frame, std::vector<int> regionCoords);
+AlprResults recognizeFrame(Alpr* alpr, cv::Mat frame, std::vector<AlprRegionOfInterest> regionsOfInterest, double* totalProcessingTime);
+bool showResults(AlprResults results, double totalProcessingTime, bool writeJson);
+void processVideoPipelined(std::vector<Alpr*> alprs, cv::VideoCapture* cap, int endatms, bool writeJson, std::vector<int> regionCoords);
+void videoDecodeThread(void* arg);
+void videoRecognizeThread(void* arg);
+void processBulk(std::vector<Alpr*> alprs, std::vector<std::string> inputs, std::string checkpointFile, std::vector<int> regionCoords);
+void bulkListThread(void* arg);
+void bulkRecognizeThread(void* arg);
+void configureAlpr(Alpr* alpr, int topn, bool debug_mode, bool detectRegion);
+std::vector<Alpr*> createRecognizers(Alpr* alpr, int num_threads, std::string country, std::string configFile, int topn, bool debug_mode, bool detectRegion);
 bool is_supported_image(std::string image_file);
 
 bool measureProcessingTime = false;
@@ -66,6 +161,9 @@ int main( int argc, const char** argv )
   bool detectRegion = false;
   std::string country;
   int topn;
+  int num_threads = 1;
+  bool bulk_mode = false;
+  std::string checkpointFile;
   bool debug_mode = false;
 
   TCLAP::CmdLine cmd("OpenAlpr Command Line Utility", ' ', Alpr::getVersion());
@@ -80,11 +178,14 @@ int main( int argc, const char** argv )
   TCLAP::ValueArg<std::string> configFileArg("","config","Path to the openalpr.conf file",false, "" ,"config_file");
   TCLAP::ValueArg<std::string> templatePatternArg("p","pattern","Attempt to match the plate number against a plate pattern (e.g., md for Maryland, ca for California)",false, "" ,"pattern code");
   TCLAP::ValueArg<int> topNArg("n","topn","Max number of possible plate numbers to return.  Default=10",false, 10 ,"topN");
+  TCLAP::ValueArg<std::string> checkpointArg("","checkpoint","With --bulk, a file recording how many of the listed images have been written.  When it exists, processing resumes after them",false, "" ,"checkpoint_file");
+  TCLAP::ValueArg<int> threadsArg("","threads","Number of recognition threads for a video file or for --bulk.  For a video file, frames are decoded on a separate thread and the results are printed in order.  With --bulk, images are listed on a separate thread, and each recognition thread decodes its own images.  Results are written in input order.  Ignored for single images and streams.  Default=1",false, 1 ,"num_threads");
 
   TCLAP::SwitchArg jsonSwitch("j","json","Output recognition results in JSON format.  Default=off", cmd, false);
   TCLAP::SwitchArg debugSwitch("","debug","Enable debug output.  Default=off", cmd, false);
   TCLAP::SwitchArg detectRegionSwitch("d","detect_region","Attempt to detect the region of the plate image.  [Experimental]  Default=off", cmd, false);
   TCLAP::SwitchArg clockSwitch("","clock","Measure/print the total time to process image and all plates.  Default=off", cmd, false);
+  TCLAP::SwitchArg bulkSwitch("", "bulk", "Treat each input as a directory of images or a manifest file listing one image path per line.  The images are decoded and recognized on --threads threads, and written as one JSON line each, in order.  Default=off", cmd, false);
   TCLAP::SwitchArg motiondetect("", "motion", "Use motion detection on video file or stream.  Default=off", cmd, false);
 
   try
@@ -93,6 +194,8 @@ int main( int argc, const char** argv )
     cmd.add( seekToMsArg );
     cmd.add( endAtMsArg ); // 2/1/2018 adt, adding to allow ending
     cmd.add( topNArg );
+    cmd.add( threadsArg );
+    cmd.add( checkpointArg );
     cmd.add( configFileArg );
     cmd.add( fileArg );
     cmd.add( countryCodeArg );
@@ -115,6 +218,9 @@ int main( int argc, const char** argv )
     detectRegion = detectRegionSwitch.getValue();
     templatePattern = templatePatternArg.getValue();
     topn = topNArg.getValue();
+    num_threads = threadsArg.getValue();
+    bulk_mode = bulkSwitch.getValue();
+    checkpointFile = checkpointArg.getValue();
     measureProcessingTime = clockSwitch.getValue();
 	  do_motiondetection = motiondetect.getValue();
     // 1/6/2016 adt, parse regionArg string into regionCoords vector
@@ -134,23 +240,23 @@ int main( int argc, const char** argv )
   cv::Mat frame;
 
   Alpr alpr(country, configFile);
-  alpr.setTopN(topn);
+  configureAlpr(&alpr, topn, debug_mode, detectRegion);
 
-  if (debug_mode)
+  if (alpr.isLoaded() == false)
   {
-    alpr.getConfig()->setDebug(true);
+    std::cerr << "Error loading OpenALPR" << std::endl;
+    return 1;
   }
 
-  if (detectRegion)
-    alpr.setDetectRegion(detectRegion);
+  if (bulk_mode)
+  {
+    std::vector<Alpr*> alprs = createRecognizers(&alpr, num_threads, country, configFile, topn, debug_mode, detectRegion);
 
-  if (templatePattern.empty() == false)
-    alpr.setDefaultRegion(templatePattern);
+    processBulk(alprs, filenames, checkpointFile, regionCoords);
 
-  if (alpr.isLoaded() == false)
-  {
-    std::cerr << "Error loading OpenALPR" << std::endl;
-    return 1;
+    for (unsigned int t = 1; t < alprs.size(); t++)
+      delete alprs[t];
+    return 0;
   }
 
   for (unsigned int i = 0; i < filenames.size(); i++)
@@ -269,6 +375,17 @@ int main( int argc, const char** argv )
         cap.open(filename);
         cap.set(CV_CAP_PROP_POS_MSEC, seektoms);
 
+        if (num_threads > 1)
+        {
+          std::vector<Alpr*> alprs = createRecognizers(&alpr, num_threads, country, configFile, topn, debug_mode, detectRegion);
+
+          processVideoPipelined(alprs, &cap, endatms, outputJson, regionCoords);
+
+          for (unsigned int t = 1; t < alprs.size(); t++)
+            delete alprs[t];
+          continue;
+        }
+
         while (cap.read(frame))
         {
           frameTime = cap.get(CV_CAP_PROP_POS_MSEC);
@@ -285,7 +402,7 @@ int main( int argc, const char** argv )
           }
           if (framenum == 0)
             motiondetector.ResetMotionDetection(&frame);
-          detectandshow(&alpr, frame, "", outputJson, regionCoords);
+          detectandshow(&alpr, frame, "", outputJson, regionCoords, framenum);
           //create a 1ms delay
           sleep_ms(1);
           framenum++;
@@ -354,12 +471,20 @@ bool is_supported_image(std::string image_file)
 }
 
 
-bool detectandshow( Alpr* alpr, cv::Mat frame, std::string region, bool writeJson, std::vector<int> regionCoords)
+bool detectandshow( Alpr* alpr, cv::Mat frame, std::string region, bool writeJson, std::vector<int> regionCoords, int64_t frame_number)
 {
+  std::vector<AlprRegionOfInterest> regionsOfInterest = getRegionsOfInterest(frame, regionCoords);
 
-  timespec startTime;
-  getTimeMonotonic(&startTime);
+  double totalProcessingTime;
+  AlprResults results = recognizeFrame(alpr, frame, regionsOfInterest, &totalProcessingTime);
+  results.frame_number = frame_number;
+
+  return showResults(results, totalProcessingTime, writeJson);
+}
 
+// Uses the motion detector, so frames from a video must be passed in order
+std::vector<AlprRegionOfInterest> getRegionsOfInterest(cv::Mat frame, std::vector<int> regionCoords)
+{
   std::vector<AlprRegionOfInterest> regionsOfInterest;
   if (do_motiondetection)
   {
@@ -372,19 +497,34 @@ bool detectandshow( Alpr* alpr, cv::Mat frame, std::string region, bool writeJso
     regionsOfInterest.push_back(AlprRegionOfInterest(regionCoords[0],regionCoords[1],regionCoords[2],regionCoords[3]));
   }
   else regionsOfInterest.push_back(AlprRegionOfInterest(0, 0, frame.cols, frame.rows));
+
+  return regionsOfInterest;
+}
+
+AlprResults recognizeFrame(Alpr* alpr, cv::Mat frame, std::vector<AlprRegionOfInterest> regionsOfInterest, double* totalProcessingTime)
+{
+  timespec startTime;
+  getTimeMonotonic(&startTime);
+
   AlprResults results;
   if (regionsOfInterest.size()>0) results = alpr->recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, regionsOfInterest);
 
   timespec endTime;
   getTimeMonotonic(&endTime);
-  double totalProcessingTime = diffclock(startTime, endTime);
+  *totalProcessingTime = diffclock(startTime, endTime);
+
+  return results;
+}
+
+bool showResults(AlprResults results, double totalProcessingTime, bool writeJson)
+{
   if (measureProcessingTime)
     std::cout << "Total Time to process image: " << totalProcessingTime << "ms." << std::endl;
 
 
   if (writeJson)
   {
-    std::cout << alpr->toJson( results ) << std::endl;
+    std::cout << Alpr::toJson( results ) << std::endl;
   }
   else
   {
@@ -417,3 +557,416 @@ bool detectandshow( Alpr* alpr, cv::Mat frame, std::string region, bool writeJso
 
   return results.plates.size() > 0;
 }
+
+void configureAlpr(Alpr* alpr, int topn, bool debug_mode, bool detectRegion)
+{
+  alpr->setTopN(topn);
+
+  if (debug_mode)
+  {
+    alpr->getConfig()->setDebug(true);
+  }
+
+  if (detectRegion)
+    alpr->setDetectRegion(detectRegion);
+
+  if (templatePattern.empty() == false)
+    alpr->setDefaultRegion(templatePattern);
+}
+
+// Returns alpr followed by enough new instances for num_threads threads.  They share alpr's models
+std::vector<Alpr*> createRecognizers(Alpr* alpr, int num_threads, std::string country, std::string configFile, int topn, bool debug_mode, bool detectRegion)
+{
+  std::vector<Alpr*> alprs;
+  alprs.push_back(alpr);
+  for (int t = 1; t < num_threads; t++)
+  {
+    Alpr* worker_alpr = new Alpr(country, configFile);
+    configureAlpr(worker_alpr, topn, debug_mode, detectRegion);
+    alprs.push_back(worker_alpr);
+  }
+
+  return alprs;
+}
+
+// Decodes the video on one thread and recognizes the frames on one thread per Alpr instance.
+// The results are printed on the calling thread in frame order
+void processVideoPipelined(std::vector<Alpr*> alprs, cv::VideoCapture* cap, int endatms, bool writeJson, std::vector<int> regionCoords)
+{
+  VideoPipeline pipeline;
+  pipeline.cap = cap;
+  pipeline.endatms = endatms;
+  pipeline.regionCoords = regionCoords;
+  pipeline.num_workers = alprs.size();
+  pipeline.frames_decoded = 0;
+  pipeline.decoding_done = false;
+
+  // Enough decoded frames to keep every recognizer busy, without reading far ahead of them
+  pipeline.frames_queue = new BoundedQueue<VideoFrame>(alprs.size() * 2, QUEUE_BLOCK);
+
+  std::vector<VideoWorker> workers(alprs.size());
+  std::vector<tthread::thread*> threads;
+  for (unsigned int i = 0; i < alprs.size(); i++)
+  {
+    workers[i].pipeline = &pipeline;
+    workers[i].alpr = alprs[i];
+    threads.push_back(new tthread::thread(videoRecognizeThread, (void*) &workers[i]));
+  }
+  threads.push_back(new tthread::thread(videoDecodeThread, (void*) &pipeline));
+
+  int next_frame = 0;
+  while (true)
+  {
+    VideoFrame recognized;
+    {
+      tthread::lock_guard<tthread::mutex> guard(pipeline.mutex);
+      while (pipeline.finished.find(next_frame) == pipeline.finished.end() &&
+             !(pipeline.decoding_done && next_frame >= pipeline.frames_decoded))
+        pipeline.frame_finished.wait(pipeline.mutex);
+
+      if (pipeline.finished.find(next_frame) == pipeline.finished.end())
+        break;
+
+      recognized = pipeline.finished[next_frame];
+      pipeline.finished.erase(next_frame);
+    }
+
+    next_frame++;
+    if (recognized.failed)
+      continue;
+
+    if (!writeJson){
+      //Output additional video data video frame and current video time 12/15/2015 adt
+      std::cout << "Processing Frame: " << recognized.framenum << " VideoFrame: " << recognized.vidFrame << " VideoTime (ms) " << recognized.frameTime << std::endl;
+    }
+    showResults(recognized.results, recognized.processingTime, writeJson);
+  }
+
+  for (unsigned int i = 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  delete pipeline.frames_queue;
+}
+
+void videoDecodeThread(void* arg)
+{
+  VideoPipeline* pipeline = (VideoPipeline*) arg;
+
+  int framenum = 0;
+  cv::Mat frame;
+  while (program_active && pipeline->cap->read(frame))
+  {
+    VideoFrame decoded;
+    decoded.framenum = framenum;
+    decoded.frameTime = pipeline->cap->get(CV_CAP_PROP_POS_MSEC);
+    decoded.vidFrame = pipeline->cap->get(CV_CAP_PROP_POS_FRAMES);
+    if (pipeline->endatms != 0 && decoded.frameTime >= pipeline->endatms)
+      break;
+    if (SAVE_LAST_VIDEO_STILL)
+    {
+      cv::imwrite(LAST_VIDEO_STILL_LOCATION, frame);
+    }
+
+    // The capture reuses its buffer for the next frame
+    decoded.frame = frame.clone();
+
+    if (framenum == 0)
+      motiondetector.ResetMotionDetection(&decoded.frame);
+    decoded.regionsOfInterest = getRegionsOfInterest(decoded.frame, pipeline->regionCoords);
+
+    pipeline->frames_queue->push(decoded);
+    framenum++;
+  }
+
+  {
+    tthread::lock_guard<tthread::mutex> guard(pipeline->mutex);
+    pipeline->frames_decoded = framenum;
+    pipeline->decoding_done = true;
+    pipeline->frame_finished.notify_all();
+  }
+
+  // One end marker for each recognizer.  They come out after every real frame
+  for (int i = 0; i < pipeline->num_workers; i++)
+  {
+    VideoFrame end_marker;
+    end_marker.framenum = -1;
+    pipeline->frames_queue->push(end_marker);
+  }
+}
+
+void videoRecognizeThread(void* arg)
+{
+  VideoWorker* worker = (VideoWorker*) arg;
+  VideoPipeline* pipeline = worker->pipeline;
+
+  VideoFrame decoded;
+  while (pipeline->frames_queue->pop(&decoded))
+  {
+    if (decoded.framenum < 0)
+      break;
+
+    // A bad frame must not take down the whole run.  It is logged and skipped
+    decoded.failed = false;
+    try
+    {
+      decoded.results = recognizeFrame(worker->alpr, decoded.frame, decoded.regionsOfInterest, &decoded.processingTime);
+      decoded.results.frame_number = decoded.framenum;
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Error recognizing frame " << decoded.framenum << ": " << e.msg << std::endl;
+      decoded.failed = true;
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Error recognizing frame " << decoded.framenum << ": " << e.what() << std::endl;
+      decoded.failed = true;
+    }
+
+    // Only the results are needed from here on
+    decoded.frame.release();
+
+    tthread::lock_guard<tthread::mutex> guard(pipeline->mutex);
+    pipeline->finished[decoded.framenum] = decoded;
+    pipeline->frame_finished.notify_all();
+  }
+}
+
+// Lists the images on one thread, and reads, decodes and recognizes them on one thread per Alpr instance.
+// The JSON lines are written on the calling thread in the order the images were listed
+void processBulk(std::vector<Alpr*> alprs, std::vector<std::string> inputs, std::string checkpointFile, std::vector<int> regionCoords)
+{
+  BulkPipeline pipeline;
+  pipeline.inputs = inputs;
+  pipeline.start_offset = 0;
+  pipeline.regionCoords = regionCoords;
+  pipeline.num_workers = alprs.size();
+  pipeline.images_listed = 0;
+  pipeline.listing_done = false;
+
+  if (checkpointFile.empty() == false && fileExists(checkpointFile.c_str()))
+  {
+    std::ifstream checkpoint(checkpointFile.c_str());
+    checkpoint >> pipeline.start_offset;
+    std::cerr << "Resuming after " << pipeline.start_offset << " images" << std::endl;
+  }
+
+  pipeline.images_queue = new BoundedQueue<BulkImage>(alprs.size() * 2, QUEUE_BLOCK);
+
+  std::vector<BulkWorker> workers(alprs.size());
+  std::vector<tthread::thread*> threads;
+  for (unsigned int i = 0; i < alprs.size(); i++)
+  {
+    workers[i].pipeline = &pipeline;
+    workers[i].alpr = alprs[i];
+    threads.push_back(new tthread::thread(bulkRecognizeThread, (void*) &workers[i]));
+  }
+  threads.push_back(new tthread::thread(bulkListThread, (void*) &pipeline));
+
+  int64_t next_image = pipeline.start_offset;
+  while (true)
+  {
+    std::string line;
+    {
+      tthread::lock_guard<tthread::mutex> guard(pipeline.mutex);
+      while (pipeline.finished.find(next_image) == pipeline.finished.end() &&
+             !(pipeline.listing_done && next_image >= pipeline.images_listed))
+        pipeline.image_finished.wait(pipeline.mutex);
+
+      if (pipeline.finished.find(next_image) == pipeline.finished.end())
+        break;
+
+      line = pipeline.finished[next_image];
+      pipeline.finished.erase(next_image);
+    }
+
+    std::cout << line << "\n";
+    next_image++;
+
+    // Only record images whose results have actually been written
+    if (checkpointFile.empty() == false && (next_image - pipeline.start_offset) % BULK_CHECKPOINT_INTERVAL == 0)
+    {
+      std::cout.flush();
+      std::ofstream checkpoint(checkpointFile.c_str(), std::ios::trunc);
+      checkpoint << next_image << std::endl;
+    }
+  }
+  std::cout.flush();
+
+  if (checkpointFile.empty() == false)
+  {
+    std::ofstream checkpoint(checkpointFile.c_str(), std::ios::trunc);
+    checkpoint << next_image << std::endl;
+  }
+
+  for (unsigned int i = 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  delete pipeline.images_queue;
+}
+
+void bulkListThread(void* arg)
+{
+  BulkPipeline* pipeline = (BulkPipeline*) arg;
+
+  // Every image counts towards the checkpoint offset, including the ones skipped to reach it
+  int64_t index = 0;
+  for (unsigned int i = 0; i < pipeline->inputs.size(); i++)
+  {
+    std::string input = pipeline->inputs[i];
+    bool is_directory = DirectoryExists(input.c_str());
+    std::vector<std::string> filenames;
+
+    // A manifest is read a line at a time, since it may list more images than fit in memory
+    std::ifstream manifest;
+
+    if (is_directory)
+    {
+      std::vector<std::string> files = getFilesInDir(input.c_str());
+      std::sort(files.begin(), files.end(), stringCompare);
+
+      for (unsigned int k = 0; k < files.size(); k++)
+      {
+        if (is_supported_image(files[k]))
+          filenames.push_back(input + "/" + files[k]);
+      }
+    }
+    else if (fileExists(input.c_str()))
+    {
+      manifest.open(input.c_str());
+    }
+    else
+    {
+      std::cerr << "Bulk input not found: " << input << std::endl;
+      continue;
+    }
+
+    unsigned int file_index = 0;
+    while (true)
+    {
+      BulkImage image;
+      if (!is_directory)
+      {
+        if (!std::getline(manifest, image.filename))
+          break;
+
+        if (image.filename.size() > 0 && image.filename[image.filename.size() - 1] == '\r')
+          image.filename.erase(image.filename.size() - 1);
+        if (image.filename.empty())
+          continue;
+      }
+      else
+      {
+        if (file_index >= filenames.size())
+          break;
+        image.filename = filenames[file_index++];
+      }
+
+      image.index = index++;
+      if (image.index < pipeline->start_offset)
+        continue;
+
+      pipeline->images_queue->push(image);
+    }
+  }
+
+  {
+    tthread::lock_guard<tthread::mutex> guard(pipeline->mutex);
+    pipeline->images_listed = index;
+    pipeline->listing_done = true;
+    pipeline->image_finished.notify_all();
+  }
+
+  // One end marker for each recognizer.  They come out after every real image
+  for (int i = 0; i < pipeline->num_workers; i++)
+  {
+    BulkImage end_marker;
+    end_marker.index = -1;
+    pipeline->images_queue->push(end_marker);
+  }
+}
+
+void bulkRecognizeThread(void* arg)
+{
+  BulkWorker* worker = (BulkWorker*) arg;
+  BulkPipeline* pipeline = worker->pipeline;
+
+  BulkImage image;
+  while (pipeline->images_queue->pop(&image))
+  {
+    if (image.index < 0)
+      break;
+
+    std::string error;
+
+    std::ifstream file(image.filename.c_str(), std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // An image that can't be read, decoded or recognized gets an error line, so that the rest of the
+    // job carries on and the line count (and so the checkpoint) still matches the images listed
+    cv::Mat frame;
+    AlprResults results;
+    if (!file.is_open())
+      error = "Image file not found";
+    else if (data.empty())
+      error = "Image invalid";
+
+    try
+    {
+      if (error.empty())
+      {
+        frame = cv::imdecode(cv::Mat(data), 1);
+        if (frame.empty())
+          error = "Image invalid";
+      }
+
+      if (error.empty())
+      {
+        std::vector<AlprRegionOfInterest> regionsOfInterest;
+        if (pipeline->regionCoords.size() >= 4)
+          regionsOfInterest.push_back(AlprRegionOfInterest(pipeline->regionCoords[0], pipeline->regionCoords[1], pipeline->regionCoords[2], pipeline->regionCoords[3]));
+        else
+          regionsOfInterest.push_back(AlprRegionOfInterest(0, 0, frame.cols, frame.rows));
+
+        double totalProcessingTime;
+        results = recognizeFrame(worker->alpr, frame, regionsOfInterest, &totalProcessingTime);
+      }
+    }
+    catch (cv::Exception& e)
+    {
+      error = "Image failed: " + e.msg;
+    }
+    catch (std::exception& e)
+    {
+      error = std::string("Image failed: ") + e.what();
+    }
+
+    if (error.empty())
+    {
+      // The filename is the first field of the results object
+      worker->writer.clear();
+      worker->writer.beginObject();
+      worker->writer.addField("filename", image.filename);
+      worker->writer.addResultsFields(results);
+      worker->writer.endObject();
+    }
+    else
+    {
+      worker->writer.clear();
+      worker->writer.beginObject();
+      worker->writer.addField("filename", image.filename);
+      worker->writer.addField("error", error);
+      worker->writer.endObject();
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(pipeline->mutex);
+    pipeline->finished[image.index] = worker->writer.str();
+    pipeline->image_finished.notify_all();
+  }
+}
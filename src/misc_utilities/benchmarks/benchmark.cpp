@@ -172,6 +172,9 @@ int main( int argc, const char** argv )
     Detector* plateDetector = createDetector(&config, &prewarp);
     OCR* ocr = createOcr(&config);
 
+    // The per-region analysis below recycles its images the same way AlprImpl does
+    MatArena arena(config.plateBuffers);
+
     vector<double> endToEndTimes;
     vector<double> regionDetectionTimes;
     vector<double> stateIdTimes;
@@ -210,6 +213,8 @@ int main( int argc, const char** argv )
         {
 	  
 	  PipelineData pipeline_data(frame, regions[z].rect, &config);
+	  if (config.plateBuffers > 0)
+	    pipeline_data.arena = &arena;
 	  
           getTimeMonotonic(&startTime);
 
@@ -283,6 +288,16 @@ int main( int argc, const char** argv )
     cout << "Post Processing Time Statistics:" << endl;
     outputStats(postProcessTimes);
     cout << endl;
+
+    cout << "Plate Image Allocations:" << endl;
+    cout << "\tRegion analysis: " << arena.getAllocations() << " allocated, " << arena.getReuses() << " reused" << endl;
+    AlprStats stats = alpr.getStats();
+    for (unsigned int i = 0; i < stats.counters.size(); i++)
+    {
+      if (stats.counters[i].name.find("plate_buffer_") == 0)
+        cout << "\tEnd to end " << stats.counters[i].name << ": " << stats.counters[i].value << endl;
+    }
+    cout << endl;
   }
   else if (benchmarkName.compare("endtoend") == 0)
   {
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "opencv2/highgui/highgui.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <iostream>
+#include <stdio.h>
+#include "support/filesystem.h"
+#include "support/utf8.h"
+#include "ocr/charactermodel.h"
+#include "../tclap/CmdLine.h"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// Takes a directory of single character crops (as written by openalpr-utils-classifychars) and
+// builds the character model used by the knn OCR engine.  The first character of each file name
+// is the character the image holds.
+int main( int argc, const char** argv )
+{
+  string inDir;
+  string outFile;
+  int neighbors;
+
+  TCLAP::CmdLine cmd("OpenAlpr Character Model Training Utility", ' ', "1.0.0");
+
+  TCLAP::UnlabeledValueArg<std::string>  inputDirArg( "input_dir", "Folder containing individual character images", true, "", "input_dir_path"  );
+  TCLAP::UnlabeledValueArg<std::string>  outputFileArg( "output_file", "Model file to write (e.g., runtime_data/ocr/lus.charmodel)", true, "", "output_file_path"  );
+
+  TCLAP::ValueArg<int> neighborsArg("","neighbors","Number of samples that vote on each character (should match ocr_knn_neighbors).  Default=5",false, 5 ,"neighbors");
+
+  try
+  {
+    cmd.add( inputDirArg );
+    cmd.add( outputFileArg );
+    cmd.add( neighborsArg );
+
+    if (cmd.parse( argc, argv ) == false)
+    {
+      // Error occurred while parsing.  Exit now.
+      return 1;
+    }
+
+    inDir = inputDirArg.getValue();
+    outFile = outputFileArg.getValue();
+    neighbors = neighborsArg.getValue();
+  }
+  catch (TCLAP::ArgException &e)    // catch any exceptions
+  {
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return 1;
+  }
+
+  if (DirectoryExists(inDir.c_str()) == false)
+  {
+    printf("Input dir does not exist\n");
+    return 1;
+  }
+
+  vector<string> files = getFilesInDir(inDir.c_str());
+  sort( files.begin(), files.end(), stringCompare );
+
+  CharacterModel model;
+
+  for (unsigned int i = 0; i < files.size(); i++)
+  {
+    if (!hasEndingInsensitive(files[i], ".png") && !hasEndingInsensitive(files[i], ".jpg"))
+      continue;
+
+    string fullpath = inDir + "/" + files[i];
+
+    Mat characterImg = imread(fullpath, CV_LOAD_IMAGE_GRAYSCALE);
+    if (characterImg.empty())
+    {
+      cout << "Unable to read: " << fullpath << endl;
+      continue;
+    }
+
+    string::iterator utf_iterator = files[i].begin();
+    int cp = utf8::next(utf_iterator, files[i].end());
+    string charcode = utf8chr(cp);
+
+    model.addSample(charcode, characterImg);
+  }
+
+  if (model.getSampleCount() < 2)
+  {
+    printf("At least two character images are required\n");
+    return 1;
+  }
+
+  vector<string> labels = model.getLabels();
+  vector<int> labelCounts = model.getLabelCounts();
+  for (unsigned int i = 0; i < labels.size(); i++)
+    cout << labels[i] << ": " << labelCounts[i] << " samples" << endl;
+
+  float accuracy = model.calibrate(neighbors);
+  cout << "Each sample classified by the others: " << (accuracy * 100) << "% correct" << endl;
+
+  if (!model.save(outFile))
+  {
+    printf("Unable to write model file\n");
+    return 1;
+  }
+
+  cout << "Wrote " << model.getSampleCount() << " samples to " << outFile << endl;
+
+  return 0;
+}
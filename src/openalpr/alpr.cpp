@@ -80,6 +80,11 @@ namespace alpr
     return impl->recognize(pixelData, bytesPerPixel, imgWidth, imgHeight, regionsOfInterest);
   }
 
+  std::vector<AlprResults> Alpr::recognizeBatch(std::vector<std::vector<char> > imageBytes)
+  {
+    return impl->recognizeBatch(imageBytes);
+  }
+
   std::string Alpr::toJson( AlprResults results )
   {
     return AlprImpl::toJson(results);
@@ -89,10 +94,24 @@ namespace alpr
     return AlprImpl::toJson(result);
   }
 
+  std::string Alpr::toJson( AlprStats stats )
+  {
+    return AlprImpl::toJson(stats);
+  }
+
   AlprResults Alpr::fromJson(std::string json) {
     return AlprImpl::fromJson(json);
   }
 
+  std::string Alpr::toBinary( AlprResults results )
+  {
+    return AlprImpl::toBinary(results);
+  }
+
+  AlprResults Alpr::fromBinary(std::string data) {
+    return AlprImpl::fromBinary(data);
+  }
+
   void Alpr::setCountry(std::string country) {
     impl->setCountry(country);
   }
@@ -131,6 +150,16 @@ namespace alpr
     return AlprImpl::getVersion();
   }
 
+  std::vector<AlprStageCount> Alpr::getRejectionCounts()
+  {
+    return impl->getRejectionCounts();
+  }
+
+  AlprStats Alpr::getStats()
+  {
+    return impl->getStats();
+  }
+
   Config* Alpr::getConfig()
   {
     return impl->config;
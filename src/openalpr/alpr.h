@@ -106,6 +106,13 @@ namespace alpr
       std::string region;
   };
 
+  // Time spent in one stage of the pipeline
+  struct AlprStageTime
+  {
+    std::string stage;
+    float time_ms;
+  };
+
   class AlprResults
   {
     public:
@@ -124,9 +131,47 @@ namespace alpr
 
       std::vector<AlprRegionOfInterest> regionsOfInterest;
 
+      // Time spent in each stage, summed over the plates in the image.  Only filled in when
+      // report_stage_times is enabled
+      std::vector<AlprStageTime> stage_times;
+
   };
 
 
+  // The number of plate regions that one stage of the plate analysis rejected
+  struct AlprStageCount
+  {
+    std::string stage;
+    int64_t rejected;
+  };
+
+  // Distribution of the time spent in one stage of the pipeline
+  struct AlprStageHistogram
+  {
+    std::string stage;
+    int64_t count;
+    double total_ms;
+    double max_ms;
+
+    // buckets[i] counts the times no greater than histogram_bounds_ms[i].  The last bucket counts the rest
+    std::vector<int64_t> buckets;
+  };
+
+  struct AlprCounter
+  {
+    std::string name;
+    int64_t value;
+  };
+
+  // Totals across every image an Alpr instance has processed
+  struct AlprStats
+  {
+    std::vector<double> histogram_bounds_ms;
+    std::vector<AlprStageHistogram> stages;
+    std::vector<AlprCounter> counters;
+    std::vector<AlprStageCount> rejections;
+  };
+
   class Config;
   class AlprImpl;
   class OPENALPR_DLL_EXPORT Alpr
@@ -160,13 +205,30 @@ namespace alpr
       // Recognize from raw pixel data.  
       AlprResults recognize(unsigned char* pixelData, int bytesPerPixel, int imgWidth, int imgHeight, std::vector<AlprRegionOfInterest> regionsOfInterest);
 
+      // Recognize a batch of encoded images.  The images and the plates within them are analyzed
+      // concurrently when plate_analysis_threads > 1.  Returns one result per image, in order.
+      std::vector<AlprResults> recognizeBatch(std::vector<std::vector<char> > imageBytes);
+
 
       static std::string toJson(const AlprResults results);
       static std::string toJson(const AlprPlateResult result);
+      static std::string toJson(const AlprStats stats);
       static AlprResults fromJson(std::string json);
 
+      // A compact binary encoding of the results (see binary_results.h for the format).
+      // fromBinary returns results without any plates if the data can't be decoded
+      static std::string toBinary(const AlprResults results);
+      static AlprResults fromBinary(std::string data);
+
       bool isLoaded();
 
+      // How many of the regions found by plate detection each stage of the analysis has rejected
+      // since this instance was created, in the order the stages run
+      std::vector<AlprStageCount> getRejectionCounts();
+
+      // Per-stage timing histograms and counters since this instance was created
+      AlprStats getStats();
+
       static std::string getVersion();
 
       Config* getConfig();
@@ -105,6 +105,38 @@ OPENALPRC_DLL_EXPORT char* openalpr_recognize_encodedimage(OPENALPR* instance, u
   return result_obj;
 }
 
+OPENALPRC_DLL_EXPORT char* openalpr_recognize_encodedimage_batch(OPENALPR* instance, unsigned char** images, long long* lengths, int count)
+{
+  std::vector<std::vector<char> > batch(count);
+  for (int i = 0; i < count; i++)
+    batch[i].assign(images[i], images[i] + lengths[i]);
+
+  std::vector<alpr::AlprResults> results = ((alpr::Alpr*) instance)->recognizeBatch(batch);
+
+  std::string json_string = "[";
+  for (unsigned int i = 0; i < results.size(); i++)
+  {
+    if (i > 0)
+      json_string += ",";
+    json_string += alpr::Alpr::toJson(results[i]);
+  }
+  json_string += "]";
+
+  char* result_obj = strdup(json_string.c_str());
+
+  return result_obj;
+}
+
+OPENALPRC_DLL_EXPORT char* openalpr_get_stats(OPENALPR* instance)
+{
+  alpr::AlprStats stats = ((alpr::Alpr*) instance)->getStats();
+  std::string json_string = alpr::Alpr::toJson(stats);
+
+  char* result_obj = strdup(json_string.c_str());
+
+  return result_obj;
+}
+
 
 OPENALPRC_DLL_EXPORT void openalpr_free_response_string(char* response)
 {
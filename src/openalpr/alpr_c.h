@@ -68,6 +68,15 @@ char* openalpr_recognize_rawimage(OPENALPR* instance, unsigned char* pixelData,
 // Recognizes the encoded (e.g., JPEG, PNG) image.  bytes are the raw bytes for the image data.
 char* openalpr_recognize_encodedimage(OPENALPR* instance, unsigned char* bytes, long long length, struct AlprCRegionOfInterest roi);
 
+// Recognizes a batch of encoded images.  images[i] holds lengths[i] bytes.  The full image is analyzed.
+// Responds with a JSON array containing one result object per image, in order.
+// Caller must call free() on the returned object
+char* openalpr_recognize_encodedimage_batch(OPENALPR* instance, unsigned char** images, long long* lengths, int count);
+
+// Responds with JSON holding the per-stage timing histograms and counters collected since the instance was created.
+// Caller must call free() on the returned object
+char* openalpr_get_stats(OPENALPR* instance);
+
 // Frees a char* response that was provided from a recognition request.
 // This is required for interoperating with managed languages (e.g., C#) that can't free the memory themselves
 void openalpr_free_response_string(char* response);
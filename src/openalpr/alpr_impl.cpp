@@ -19,9 +19,13 @@
 
 #include "alpr_impl.h"
 #include "result_aggregator.h"
+#include "json_writer.h"
+#include "binary_results.h"
 
 
 void plateAnalysisThread(void* arg);
+void countryPassThread(void* arg);
+void batchPrepareThread(void* arg);
 
 using namespace std;
 using namespace cv;
@@ -37,6 +41,8 @@ namespace alpr
     config = new Config(country, configFile, runtimeDir);
 
     prewarp = ALPR_NULL_PTR;
+    threadPool = ALPR_NULL_PTR;
+    arenaPool = ALPR_NULL_PTR;
 
 
     // Config file or runtime dir not found.  Don't process any further.
@@ -46,6 +52,9 @@ namespace alpr
     }
 
     prewarp = new PreWarp(config);
+
+    if (config->plateBuffers > 0)
+      arenaPool = new MatArenaPool(config->plateBuffers);
     
     loadRecognizers();
 
@@ -64,14 +73,18 @@ namespace alpr
 
   AlprImpl::~AlprImpl()
   {
+    delete threadPool;
+
+    delete arenaPool;
+
     delete config;
 
     typedef std::map<std::string, AlprRecognizers>::iterator it_type;
     for(it_type iterator = recognizers.begin(); iterator != recognizers.end(); iterator++) {
 
-      delete iterator->second.plateDetector;
-      delete iterator->second.stateDetector;
-      delete iterator->second.ocr;
+      delete iterator->second.detectorPool;
+      ModelBundle::release(iterator->second.models);
+      delete iterator->second.config;
     }
 
     delete prewarp;
@@ -126,42 +139,41 @@ namespace alpr
     if (img.channels() > 2)
       cvtColor( img, grayImg, CV_BGR2GRAY );
 
-    // Prewarp the image and ROIs if configured]
+    // Prewarp the image and ROIs if configured.  Warping updates the transform, so use a copy
+    // that the passes below can read while other threads are working.  Copies share the
+    // transforms and lookup maps already computed for this image size
+    PreWarp imagePrewarp(*prewarp);
     std::vector<cv::Rect> warpedRegionsOfInterest = regionsOfInterest;
     // Warp the image if prewarp is provided
-    grayImg = prewarp->warpImage(grayImg);
-    warpedRegionsOfInterest = prewarp->projectRects(regionsOfInterest, grayImg.cols, grayImg.rows, false);
+    grayImg = imagePrewarp.warpImage(grayImg, regionsOfInterest);
+    warpedRegionsOfInterest = imagePrewarp.projectRects(regionsOfInterest, grayImg.cols, grayImg.rows, false);
 
-    // Iterate through each country provided (typically just one)
-    // and aggregate the results if necessary
-    ResultAggregator country_aggregator(MERGE_PICK_BEST, topN, config);
-    for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
-    {
-      if (config->debugGeneral)
-        cout << "Analyzing: " << config->loaded_countries[i] << endl;
+    refreshCountryConfigs();
 
-      config->setCountry(config->loaded_countries[i]);
-      
-      // Reapply analysis for each multiple analysis value set in the config,
-      // make a minor imperceptible tweak to the input image each time
-      ResultAggregator iter_aggregator(MERGE_COMBINE, topN, config);
-      for (unsigned int iteration = 0; iteration < config->analysis_count; iteration++)
-      {
-        Mat iteration_image = iter_aggregator.applyImperceptibleChange(grayImg, iteration);
-        //drawAndWait(iteration_image);
-        AlprFullDetails iter_results = analyzeSingleCountry(img, iteration_image, warpedRegionsOfInterest);
-        iter_aggregator.addResults(iter_results);
-      }
-      
-      AlprFullDetails sub_results = iter_aggregator.getAggregateResults();
-      sub_results.results.epoch_time = start_time;
-      sub_results.results.img_width = img.cols;
-      sub_results.results.img_height = img.rows;
-      sub_results.results.regionsOfInterest = response.results.regionsOfInterest;
-      
-      country_aggregator.addResults(sub_results);
+    // Each country provided (typically just one) and each analysis_count iteration is an
+    // independent pass over the image.  Run them concurrently, then aggregate the results
+    ImagePasses imagePasses;
+    createCountryPasses(&imagePasses, img, grayImg, warpedRegionsOfInterest, &imagePrewarp);
+
+    TaskGroup passGroup;
+    try
+    {
+      runCountryPasses(&imagePasses, &passGroup);
+      if (threadPool != ALPR_NULL_PTR)
+        threadPool->wait(&passGroup);
+
+      // Report a failed pass to the caller, as a serial run would have
+      cv::Exception error;
+      if (countryPassFailed(&imagePasses, &error))
+        throw error;
     }
-    response = country_aggregator.getAggregateResults();
+    catch (...)
+    {
+      releaseCountryPasses(&imagePasses);
+      throw;
+    }
+
+    response = aggregateCountryPasses(&imagePasses, start_time, img.cols, img.rows, response.results.regionsOfInterest);
 
     timespec endTime;
     getTimeMonotonic(&endTime);
@@ -238,19 +250,157 @@ namespace alpr
     return response;
   }
 
-  AlprFullDetails AlprImpl::analyzeSingleCountry(cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest)
+  void AlprImpl::createCountryPasses(ImagePasses* imagePasses, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest, PreWarp* imagePrewarp)
+  {
+    imagePasses->stageTimes = new StageTimes(&stageStats);
+
+    for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
+    {
+      if (config->debugGeneral)
+        cout << "Analyzing: " << config->loaded_countries[i] << endl;
+
+      Config* country_config = recognizers.find(config->loaded_countries[i])->second.config;
+
+      // Reapply analysis for each multiple analysis value set in the config,
+      // make a minor imperceptible tweak to the input image each time
+      ResultAggregator* iter_aggregator = new ResultAggregator(MERGE_COMBINE, topN, country_config);
+      imagePasses->iterAggregators.push_back(iter_aggregator);
+
+      for (unsigned int iteration = 0; iteration < country_config->analysis_count; iteration++)
+      {
+        if (iteration >= imagePasses->detectionContexts.size())
+          imagePasses->detectionContexts.push_back(new DetectionContext());
+
+        CountryPassTask pass;
+        pass.impl = this;
+        pass.country = config->loaded_countries[i];
+        pass.iteration = iteration;
+        pass.iterAggregator = iter_aggregator;
+        pass.detectionContext = imagePasses->detectionContexts[iteration];
+        pass.stageTimes = imagePasses->stageTimes;
+        pass.colorImg = colorImg;
+        pass.grayImg = grayImg;
+        pass.warpedRegionsOfInterest = warpedRegionsOfInterest;
+        pass.prewarp = imagePrewarp;
+        pass.failed = false;
+
+        imagePasses->passes.push_back(pass);
+      }
+    }
+  }
+
+  void AlprImpl::runCountryPasses(ImagePasses* imagePasses, TaskGroup* taskGroup)
+  {
+    for (unsigned int i = 0; i < imagePasses->passes.size(); i++)
+    {
+      if (threadPool != ALPR_NULL_PTR)
+        threadPool->enqueue(countryPassThread, &imagePasses->passes[i], taskGroup);
+      else
+        countryPassThread(&imagePasses->passes[i]);
+    }
+  }
+
+  AlprFullDetails AlprImpl::aggregateCountryPasses(ImagePasses* imagePasses, int64_t start_time, int img_width, int img_height, std::vector<AlprRegionOfInterest> regionsOfInterest)
+  {
+    // Merge in the same order as the passes would have run serially
+    ResultAggregator country_aggregator(MERGE_PICK_BEST, topN, config);
+
+    unsigned int pass_idx = 0;
+    for (unsigned int i = 0; i < imagePasses->iterAggregators.size(); i++)
+    {
+      ResultAggregator* iter_aggregator = imagePasses->iterAggregators[i];
+
+      while (pass_idx < imagePasses->passes.size() && imagePasses->passes[pass_idx].iterAggregator == iter_aggregator)
+      {
+        iter_aggregator->addResults(imagePasses->passes[pass_idx].results);
+        pass_idx++;
+      }
+
+      AlprFullDetails sub_results = iter_aggregator->getAggregateResults();
+      sub_results.results.epoch_time = start_time;
+      sub_results.results.img_width = img_width;
+      sub_results.results.img_height = img_height;
+      sub_results.results.regionsOfInterest = regionsOfInterest;
+
+      country_aggregator.addResults(sub_results);
+    }
+
+    AlprFullDetails response = country_aggregator.getAggregateResults();
+
+    stageStats.addCount("images");
+    if (config->reportStageTimes)
+      response.results.stage_times = imagePasses->stageTimes->getTimes();
+
+    releaseCountryPasses(imagePasses);
+
+    return response;
+  }
+
+  // Copies the first failed pass's exception into error
+  bool AlprImpl::countryPassFailed(ImagePasses* imagePasses, cv::Exception* error)
+  {
+    for (unsigned int i = 0; i < imagePasses->passes.size(); i++)
+    {
+      if (imagePasses->passes[i].failed)
+      {
+        *error = imagePasses->passes[i].error;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void AlprImpl::releaseCountryPasses(ImagePasses* imagePasses)
+  {
+    for (unsigned int i = 0; i < imagePasses->iterAggregators.size(); i++)
+      delete imagePasses->iterAggregators[i];
+    imagePasses->iterAggregators.clear();
+
+    for (unsigned int i = 0; i < imagePasses->detectionContexts.size(); i++)
+      delete imagePasses->detectionContexts[i];
+    imagePasses->detectionContexts.clear();
+
+    delete imagePasses->stageTimes;
+    imagePasses->stageTimes = NULL;
+
+    imagePasses->passes.clear();
+  }
+
+  void AlprImpl::analyzeCountryPass(CountryPassTask* task)
+  {
+    // Every country sees the same change for an iteration, so only the first pass to get here makes it
+    Mat iteration_image = task->detectionContext->getFrame();
+    if (iteration_image.empty())
+    {
+      iteration_image = task->iterAggregator->applyImperceptibleChange(task->grayImg, task->iteration);
+      iteration_image = task->detectionContext->setFrame(iteration_image);
+    }
+    //drawAndWait(iteration_image);
+    task->results = analyzeSingleCountry(task->country, task->colorImg, iteration_image, task->warpedRegionsOfInterest, task->prewarp,
+                                         task->detectionContext, task->stageTimes);
+  }
+
+  AlprFullDetails AlprImpl::analyzeSingleCountry(std::string country, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest, PreWarp* imagePrewarp,
+                                                 DetectionContext* detectionContext, StageTimes* stageTimes)
   {
     AlprFullDetails response;
 
-    AlprRecognizers country_recognizers = recognizers[config->country];
+    AlprRecognizers country_recognizers = recognizers.find(country)->second;
     timespec startTime;
     getTimeMonotonic(&startTime);
 
     vector<PlateRegion> warpedPlateRegions;
     // Find all the candidate regions
-    if (config->skipDetection == false)
+    if (country_recognizers.config->skipDetection == false)
     {
-      warpedPlateRegions = country_recognizers.plateDetector->detect(grayImg, warpedRegionsOfInterest);
+      timespec detectStartTime;
+      getTimeMonotonic(&detectStartTime);
+
+      DetectorGuard plateDetector(country_recognizers.detectorPool);
+      warpedPlateRegions = plateDetector.get()->detect(grayImg, warpedRegionsOfInterest, detectionContext);
+
+      stageTimes->addTimeSince(STAGE_DETECT, detectStartTime);
     }
     else
     {
@@ -264,170 +414,282 @@ namespace alpr
       }
     }
 
-    queue<PlateRegion> plateQueue;
-    for (unsigned int i = 0; i < warpedPlateRegions.size(); i++)
-      plateQueue.push(warpedPlateRegions[i]);
-
+    // Analyze the candidates one "wave" at a time.  The children of rejected regions form the
+    // next wave, which keeps the plate order identical to a breadth-first walk of the regions.
     int platecount = 0;
-    while(!plateQueue.empty())
+    vector<PlateRegion> plateWave = warpedPlateRegions;
+    while (plateWave.size() > 0)
     {
-      PlateRegion plateRegion = plateQueue.front();
-      plateQueue.pop();
+      vector<PlateAnalysisTask> tasks(plateWave.size());
+      TaskGroup taskGroup;
 
-      PipelineData pipeline_data(colorImg, grayImg, plateRegion.rect, config);
-      pipeline_data.prewarp = prewarp;
-
-      timespec platestarttime;
-      getTimeMonotonic(&platestarttime);
-
-      LicensePlateCandidate lp(&pipeline_data);
+      for (unsigned int i = 0; i < plateWave.size(); i++)
+      {
+        tasks[i].impl = this;
+        tasks[i].recognizers = &country_recognizers;
+        tasks[i].prewarp = imagePrewarp;
+        tasks[i].colorImg = colorImg;
+        tasks[i].grayImg = grayImg;
+        tasks[i].plateRegion = plateWave[i];
+        tasks[i].stageTimes = stageTimes;
+        tasks[i].plateDetected = false;
+        tasks[i].failed = false;
+
+        if (threadPool != ALPR_NULL_PTR)
+          threadPool->enqueue(plateAnalysisThread, &tasks[i], &taskGroup);
+        else
+          analyzePlateRegion(&tasks[i]);
+      }
 
-      lp.recognize();
+      if (threadPool != ALPR_NULL_PTR)
+        threadPool->wait(&taskGroup);
 
-      bool plateDetected = false;
-      if (pipeline_data.disqualified && config->debugGeneral)
+      // Analyzing the plates serially would have stopped at the first failure
+      for (unsigned int i = 0; i < tasks.size(); i++)
       {
-        cout << "Disqualify reason: " << pipeline_data.disqualify_reason << endl;
+        if (tasks[i].failed)
+          throw tasks[i].error;
       }
-      if (!pipeline_data.disqualified)
+
+      vector<PlateRegion> nextWave;
+      for (unsigned int i = 0; i < tasks.size(); i++)
       {
-        AlprPlateResult plateResult;
+        if (tasks[i].plateDetected)
+        {
+          tasks[i].plateResult.plate_index = platecount++;
+          response.results.plates.push_back(tasks[i].plateResult);
+        }
+        else
+        {
+          // Not a valid plate
+          // Check if this plate has any children, if so, send them back up for processing
+          for (unsigned int childidx = 0; childidx < tasks[i].plateRegion.children.size(); childidx++)
+            nextWave.push_back(tasks[i].plateRegion.children[childidx]);
+        }
+      }
 
-        plateResult.country = config->country;
+      plateWave = nextWave;
+    }
 
-        // If there's only one pattern for a country, use it.  Otherwise use the default
-        if (country_recognizers.ocr->postProcessor.getPatterns().size() == 1)
-          plateResult.region = country_recognizers.ocr->postProcessor.getPatterns()[0];
-        else
-          plateResult.region = defaultRegion;
+    // Unwarp plate regions if necessary
+    imagePrewarp->projectPlateRegions(warpedPlateRegions, grayImg.cols, grayImg.rows, true);
+    response.plateRegions = warpedPlateRegions;
 
-        plateResult.regionConfidence = 0;
-        plateResult.plate_index = platecount++;
-        plateResult.requested_topn = topN;
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    response.results.total_processing_time_ms = diffclock(startTime, endTime);
 
-        // If using prewarp, remap the plate corners to the original image
-        vector<Point2f> cornerPoints = pipeline_data.plate_corners;
-        cornerPoints = prewarp->projectPoints(cornerPoints, true);
+    return response;
+  }
 
-        for (int pointidx = 0; pointidx < 4; pointidx++)
-        {
-          plateResult.plate_points[pointidx].x = (int) cornerPoints[pointidx].x;
-          plateResult.plate_points[pointidx].y = (int) cornerPoints[pointidx].y;
-        }
+  void AlprImpl::analyzePlateRegion(PlateAnalysisTask* task)
+  {
+    Config* country_config = task->recognizers->config;
 
-        
-        #ifndef SKIP_STATE_DETECTION
-        if (detectRegion && country_recognizers.stateDetector->isLoaded())
-        {
-          std::vector<StateCandidate> state_candidates = country_recognizers.stateDetector->detect(pipeline_data.color_deskewed.data,
-                                                                               pipeline_data.color_deskewed.elemSize(),
-                                                                               pipeline_data.color_deskewed.cols,
-                                                                               pipeline_data.color_deskewed.rows);
-
-          if (state_candidates.size() > 0)
-          {
-            plateResult.region = state_candidates[0].state_code;
-            plateResult.regionConfidence = (int) state_candidates[0].confidence;
-          }
-        }
-        #endif
+    PipelineData pipeline_data(task->colorImg, task->grayImg, task->plateRegion.rect, country_config);
+    pipeline_data.prewarp = task->prewarp;
+    pipeline_data.stage_times = task->stageTimes;
 
-        if (plateResult.region.length() > 0 && country_recognizers.ocr->postProcessor.regionIsValid(plateResult.region) == false)
-        {
-          std::cerr << "Invalid pattern provided: " << plateResult.region << std::endl;
-          std::cerr << "Valid patterns are located in the " << config->country << ".patterns file" << std::endl;
-        }
+    ArenaGuard arena(this);
+    pipeline_data.arena = arena.get();
 
-        country_recognizers.ocr->performOCR(&pipeline_data);
-        country_recognizers.ocr->postProcessor.analyze(plateResult.region, topN);
+    stageStats.addCount("plate_regions");
 
-        timespec resultsStartTime;
-        getTimeMonotonic(&resultsStartTime);
+    timespec platestarttime;
+    getTimeMonotonic(&platestarttime);
 
-        const vector<PPResult> ppResults = country_recognizers.ocr->postProcessor.getResults();
+    LicensePlateCandidate lp(&pipeline_data);
 
-        int bestPlateIndex = 0;
+    lp.recognize();
 
-        cv::Mat charTransformMatrix = getCharacterTransformMatrix(&pipeline_data);
-        bool isBestPlateSelected = false;
-        for (unsigned int pp = 0; pp < ppResults.size(); pp++)
-        {
+    task->plateDetected = false;
+    if (pipeline_data.disqualified && country_config->debugGeneral)
+    {
+      cout << "Disqualify reason: " << pipeline_data.disqualify_reason << endl;
+    }
+    if (pipeline_data.disqualified)
+    {
+      stageStats.addRejection(pipeline_data.disqualify_stage);
+      return;
+    }
 
-          // Set our "best plate" match to either the first entry, or the first entry with a postprocessor template match
-          if (isBestPlateSelected == false && ppResults[pp].matchesTemplate){
-            bestPlateIndex = plateResult.topNPlates.size();
-            isBestPlateSelected = true;
-          }
-
-          AlprPlate aplate;
-          aplate.characters = ppResults[pp].letters;
-          aplate.overall_confidence = ppResults[pp].totalscore;
-          aplate.matches_template = ppResults[pp].matchesTemplate;
-
-          // Grab detailed results for each character
-          for (unsigned int c_idx = 0; c_idx < ppResults[pp].letter_details.size(); c_idx++)
-          {
-            AlprChar character_details;
-            Letter l = ppResults[pp].letter_details[c_idx];
-
-            character_details.character = l.letter;
-            character_details.confidence = l.totalscore;
-            cv::Rect char_rect = pipeline_data.charRegionsFlat[l.charposition];
-            std::vector<AlprCoordinate> charpoints = getCharacterPoints(char_rect, charTransformMatrix );
-            for (int cpt = 0; cpt < 4; cpt++)
-              character_details.corners[cpt] = charpoints[cpt];
-            aplate.character_details.push_back(character_details);
-          }
-          plateResult.topNPlates.push_back(aplate);
-        }
+    AlprPlateResult& plateResult = task->plateResult;
 
-        if (plateResult.topNPlates.size() > bestPlateIndex)
-        {
-          AlprPlate bestPlate;
-          bestPlate.characters = plateResult.topNPlates[bestPlateIndex].characters;
-          bestPlate.matches_template = plateResult.topNPlates[bestPlateIndex].matches_template;
-          bestPlate.overall_confidence = plateResult.topNPlates[bestPlateIndex].overall_confidence;
-          bestPlate.character_details = plateResult.topNPlates[bestPlateIndex].character_details;
+    plateResult.country = country_config->country;
 
-          plateResult.bestPlate = bestPlate;
-        }
+    // Tesseract and the postprocessor are not thread-safe.  Borrow an instance for the rest of this plate
+    OcrGuard ocrGuard(task->recognizers->models->ocrPool, country_config);
+    OCR* ocr = ocrGuard.get();
 
-        timespec plateEndTime;
-        getTimeMonotonic(&plateEndTime);
-        plateResult.processing_time_ms = diffclock(platestarttime, plateEndTime);
-        if (config->debugTiming)
-        {
-          cout << "Result Generation Time: " << diffclock(resultsStartTime, plateEndTime) << "ms." << endl;
-        }
+    // If there's only one pattern for a country, use it.  Otherwise use the default
+    if (ocr->postProcessor.getPatterns().size() == 1)
+      plateResult.region = ocr->postProcessor.getPatterns()[0];
+    else
+      plateResult.region = defaultRegion;
 
-        if (plateResult.topNPlates.size() > 0)
-        {
-          plateDetected = true;
-          response.results.plates.push_back(plateResult);
-        }
+    plateResult.regionConfidence = 0;
+    plateResult.requested_topn = topN;
+
+    // If using prewarp, remap the plate corners to the original image
+    vector<Point2f> cornerPoints = pipeline_data.plate_corners;
+    cornerPoints = task->prewarp->projectPoints(cornerPoints, true);
+
+    for (int pointidx = 0; pointidx < 4; pointidx++)
+    {
+      plateResult.plate_points[pointidx].x = (int) cornerPoints[pointidx].x;
+      plateResult.plate_points[pointidx].y = (int) cornerPoints[pointidx].y;
+    }
+
+
+    #ifndef SKIP_STATE_DETECTION
+    if (detectRegion && task->recognizers->models->stateDetector->isLoaded())
+    {
+      tthread::lock_guard<tthread::mutex> guard(task->recognizers->models->stateDetectorMutex);
+      std::vector<StateCandidate> state_candidates = task->recognizers->models->stateDetector->detect(pipeline_data.color_deskewed.data,
+                                                                           pipeline_data.color_deskewed.elemSize(),
+                                                                           pipeline_data.color_deskewed.cols,
+                                                                           pipeline_data.color_deskewed.rows);
+
+      if (state_candidates.size() > 0)
+      {
+        plateResult.region = state_candidates[0].state_code;
+        plateResult.regionConfidence = (int) state_candidates[0].confidence;
       }
+    }
+    #endif
 
-      if (!plateDetected)
+    if (plateResult.region.length() > 0 && ocr->postProcessor.regionIsValid(plateResult.region) == false)
+    {
+      std::cerr << "Invalid pattern provided: " << plateResult.region << std::endl;
+      std::cerr << "Valid patterns are located in the " << country_config->country << ".patterns file" << std::endl;
+    }
+
+    ocr->performOCR(&pipeline_data);
+
+    timespec postProcessStartTime;
+    getTimeMonotonic(&postProcessStartTime);
+    ocr->postProcessor.analyze(plateResult.region, topN);
+    pipeline_data.addStageTime(STAGE_POSTPROCESS, postProcessStartTime);
+
+    timespec resultsStartTime;
+    getTimeMonotonic(&resultsStartTime);
+
+    const vector<PPResult> ppResults = ocr->postProcessor.getResults();
+
+    ocrGuard.release();
+
+    int bestPlateIndex = 0;
+
+    cv::Mat charTransformMatrix = getCharacterTransformMatrix(&pipeline_data);
+    bool isBestPlateSelected = false;
+    for (unsigned int pp = 0; pp < ppResults.size(); pp++)
+    {
+
+      // Set our "best plate" match to either the first entry, or the first entry with a postprocessor template match
+      if (isBestPlateSelected == false && ppResults[pp].matchesTemplate){
+        bestPlateIndex = plateResult.topNPlates.size();
+        isBestPlateSelected = true;
+      }
+
+      AlprPlate aplate;
+      aplate.characters = ppResults[pp].letters;
+      aplate.overall_confidence = ppResults[pp].totalscore;
+      aplate.matches_template = ppResults[pp].matchesTemplate;
+
+      // Grab detailed results for each character
+      for (unsigned int c_idx = 0; c_idx < ppResults[pp].letter_details.size(); c_idx++)
       {
-        // Not a valid plate
-        // Check if this plate has any children, if so, send them back up for processing
-        for (unsigned int childidx = 0; childidx < plateRegion.children.size(); childidx++)
-        {
-          plateQueue.push(plateRegion.children[childidx]);
-        }
+        AlprChar character_details;
+        Letter l = ppResults[pp].letter_details[c_idx];
+
+        character_details.character = l.letter;
+        character_details.confidence = l.totalscore;
+        cv::Rect char_rect = pipeline_data.charRegionsFlat[l.charposition];
+        std::vector<AlprCoordinate> charpoints = getCharacterPoints(char_rect, charTransformMatrix, task->prewarp);
+        for (int cpt = 0; cpt < 4; cpt++)
+          character_details.corners[cpt] = charpoints[cpt];
+        aplate.character_details.push_back(character_details);
       }
+      plateResult.topNPlates.push_back(aplate);
+    }
 
+    if (plateResult.topNPlates.size() > bestPlateIndex)
+    {
+      AlprPlate bestPlate;
+      bestPlate.characters = plateResult.topNPlates[bestPlateIndex].characters;
+      bestPlate.matches_template = plateResult.topNPlates[bestPlateIndex].matches_template;
+      bestPlate.overall_confidence = plateResult.topNPlates[bestPlateIndex].overall_confidence;
+      bestPlate.character_details = plateResult.topNPlates[bestPlateIndex].character_details;
+
+      plateResult.bestPlate = bestPlate;
     }
 
-    // Unwarp plate regions if necessary
-    prewarp->projectPlateRegions(warpedPlateRegions, grayImg.cols, grayImg.rows, true);
-    response.plateRegions = warpedPlateRegions;
+    timespec plateEndTime;
+    getTimeMonotonic(&plateEndTime);
+    plateResult.processing_time_ms = diffclock(platestarttime, plateEndTime);
+    if (country_config->debugTiming)
+    {
+      cout << "Result Generation Time: " << diffclock(resultsStartTime, plateEndTime) << "ms." << endl;
+    }
 
-    timespec endTime;
-    getTimeMonotonic(&endTime);
-    response.results.total_processing_time_ms = diffclock(startTime, endTime);
+    if (plateResult.topNPlates.size() > 0)
+    {
+      task->plateDetected = true;
+      stageStats.addCount("plates_read");
+    }
+    else
+    {
+      stageStats.addRejection("ocr");
+    }
+  }
 
-    return response;
+  ArenaGuard::ArenaGuard(AlprImpl* alpr)
+  {
+    this->alpr = alpr;
+    this->arena = alpr->acquireArena();
+  }
+
+  ArenaGuard::~ArenaGuard()
+  {
+    alpr->releaseArena(arena);
+  }
+
+  MatArena* ArenaGuard::get()
+  {
+    return arena;
+  }
+
+  // NULL when plate_buffers is 0
+  MatArena* AlprImpl::acquireArena()
+  {
+    if (arenaPool == ALPR_NULL_PTR)
+      return ALPR_NULL_PTR;
+
+    return arenaPool->acquire();
+  }
+
+  // The images still held by this plate's PipelineData stay in use until it goes out of scope,
+  // so the arena can be handed to the next plate right away
+  void AlprImpl::releaseArena(MatArena* arena)
+  {
+    if (arena == ALPR_NULL_PTR)
+      return;
+
+    stageStats.addCount("plate_buffer_allocations", arena->getAllocations());
+    stageStats.addCount("plate_buffer_reuses", arena->getReuses());
+    arena->resetCounts();
+
+    arenaPool->release(arena);
+  }
+
+  std::vector<AlprStageCount> AlprImpl::getRejectionCounts()
+  {
+    return stageStats.getRejectionCounts();
+  }
+
+  AlprStats AlprImpl::getStats()
+  {
+    return stageStats.getStats();
   }
 
   AlprResults AlprImpl::recognize( std::vector<char> imageBytes)
@@ -505,6 +767,121 @@ namespace alpr
   }
 
 
+  std::vector<AlprResults> AlprImpl::recognizeBatch(std::vector<std::vector<char> > imageBytes)
+  {
+    timespec startTime;
+    getTimeMonotonic(&startTime);
+
+    std::vector<BatchImageTask> tasks(imageBytes.size());
+    for (unsigned int i = 0; i < tasks.size(); i++)
+    {
+      tasks[i].impl = this;
+      tasks[i].imageBytes = &imageBytes[i];
+      tasks[i].prewarp = new PreWarp(*prewarp);
+    }
+
+    // An image that throws OpenCV exceptions gets empty results.  Anything else fails the batch
+    try
+    {
+      // Decode, convert and warp every image once
+      TaskGroup prepareGroup;
+      for (unsigned int i = 0; i < tasks.size(); i++)
+      {
+        if (threadPool != ALPR_NULL_PTR)
+          threadPool->enqueue(batchPrepareThread, &tasks[i], &prepareGroup);
+        else
+          batchPrepareThread(&tasks[i]);
+      }
+      if (threadPool != ALPR_NULL_PTR)
+        threadPool->wait(&prepareGroup);
+
+      refreshCountryConfigs();
+
+      // Every country/iteration pass of every image shares the pool (along with the plates within them)
+      TaskGroup passGroup;
+      for (unsigned int i = 0; i < tasks.size(); i++)
+      {
+        if (!tasks[i].img.data)
+          continue;
+
+        createCountryPasses(&tasks[i].imagePasses, tasks[i].img, tasks[i].grayImg, tasks[i].warpedRegionsOfInterest, tasks[i].prewarp);
+        runCountryPasses(&tasks[i].imagePasses, &passGroup);
+      }
+      if (threadPool != ALPR_NULL_PTR)
+        threadPool->wait(&passGroup);
+    }
+    catch (...)
+    {
+      for (unsigned int i = 0; i < tasks.size(); i++)
+      {
+        releaseCountryPasses(&tasks[i].imagePasses);
+        delete tasks[i].prewarp;
+      }
+      throw;
+    }
+
+    std::vector<AlprResults> allResults;
+    for (unsigned int i = 0; i < tasks.size(); i++)
+    {
+      delete tasks[i].prewarp;
+
+      cv::Exception error;
+      bool failed = countryPassFailed(&tasks[i].imagePasses, &error);
+      if (failed)
+        std::cerr << "Caught exception in OpenALPR recognizeBatch: " << error.msg << std::endl;
+
+      if (!tasks[i].img.data || tasks[i].imagePasses.iterAggregators.size() == 0 || failed)
+      {
+        releaseCountryPasses(&tasks[i].imagePasses);
+
+        if (this->config->debugGeneral)
+          std::cerr << "Unable to process image in batch at index " << i << std::endl;
+
+        AlprResults emptyresults;
+        allResults.push_back(emptyresults);
+        continue;
+      }
+
+      std::vector<AlprRegionOfInterest> regionsOfInterest;
+      for (unsigned int r = 0; r < tasks[i].regionsOfInterest.size(); r++)
+      {
+        cv::Rect roi = tasks[i].regionsOfInterest[r];
+        regionsOfInterest.push_back(AlprRegionOfInterest(roi.x, roi.y, roi.width, roi.height));
+      }
+
+      AlprFullDetails fullDetails = aggregateCountryPasses(&tasks[i].imagePasses, tasks[i].start_time, tasks[i].img.cols, tasks[i].img.rows, regionsOfInterest);
+      allResults.push_back(fullDetails.results);
+    }
+
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    if (config->debugTiming)
+    {
+      cout << "Total Time to process batch of " << tasks.size() << " images: " << diffclock(startTime, endTime) << "ms." << endl;
+    }
+
+    return allResults;
+  }
+
+  void AlprImpl::prepareBatchImage(BatchImageTask* task)
+  {
+    task->start_time = getEpochTimeMs();
+
+    task->img = cv::imdecode(cv::Mat(*task->imageBytes), 1);
+    if (!task->img.data)
+      return;
+
+    task->regionsOfInterest.push_back(cv::Rect(0, 0, task->img.cols, task->img.rows));
+
+    // Convert image to grayscale if required
+    task->grayImg = task->img;
+    if (task->img.channels() > 2)
+      cvtColor( task->img, task->grayImg, CV_BGR2GRAY );
+
+    task->grayImg = task->prewarp->warpImage(task->grayImg, task->regionsOfInterest);
+    task->warpedRegionsOfInterest = task->prewarp->projectRects(task->regionsOfInterest, task->grayImg.cols, task->grayImg.rows, false);
+  }
+
    std::vector<cv::Rect> AlprImpl::convertRects(std::vector<AlprRegionOfInterest> regionsOfInterest)
    {
      std::vector<cv::Rect> rectRegions;
@@ -518,42 +895,52 @@ namespace alpr
 
   string AlprImpl::toJson( const AlprResults results )
   {
-    cJSON *root, *jsonResults;
-    root = cJSON_CreateObject();
+    JsonWriter writer;
+    writer.beginObject();
+    writer.addResultsFields(results);
+    writer.endObject();
 
+    return writer.str();
+  }
 
-    cJSON_AddNumberToObject(root,"version",	2	  );
-    cJSON_AddStringToObject(root,"data_type",	"alpr_results"	  );
 
-    cJSON_AddNumberToObject(root,"epoch_time",	results.epoch_time	  );
-    cJSON_AddNumberToObject(root,"img_width",	results.img_width	  );
-    cJSON_AddNumberToObject(root,"img_height",	results.img_height	  );
-    cJSON_AddNumberToObject(root,"processing_time_ms", results.total_processing_time_ms );
 
-    // Add the regions of interest to the JSON
-    cJSON *rois;
-    cJSON_AddItemToObject(root, "regions_of_interest", 		rois=cJSON_CreateArray());
-    for (unsigned int i=0;i<results.regionsOfInterest.size();i++)
-    {
-      cJSON *roi_object;
-      roi_object = cJSON_CreateObject();
-      cJSON_AddNumberToObject(roi_object, "x",  results.regionsOfInterest[i].x);
-      cJSON_AddNumberToObject(roi_object, "y",  results.regionsOfInterest[i].y);
-      cJSON_AddNumberToObject(roi_object, "width",  results.regionsOfInterest[i].width);
-      cJSON_AddNumberToObject(roi_object, "height",  results.regionsOfInterest[i].height);
+  std::string AlprImpl::toJson( const AlprStats stats )
+  {
+    cJSON *root, *bounds, *stages, *counters, *rejections;
+    root = cJSON_CreateObject();
 
-      cJSON_AddItemToArray(rois, roi_object);
-    }
+    cJSON_AddStringToObject(root,"data_type",	"alpr_stats"	  );
 
+    cJSON_AddItemToObject(root, "histogram_bounds_ms", bounds=cJSON_CreateArray());
+    for (unsigned int i = 0; i < stats.histogram_bounds_ms.size(); i++)
+      cJSON_AddItemToArray(bounds, cJSON_CreateNumber(stats.histogram_bounds_ms[i]));
 
-    cJSON_AddItemToObject(root, "results", 		jsonResults=cJSON_CreateArray());
-    for (unsigned int i = 0; i < results.plates.size(); i++)
+    cJSON_AddItemToObject(root, "stages", stages=cJSON_CreateArray());
+    for (unsigned int i = 0; i < stats.stages.size(); i++)
     {
-      cJSON *resultObj = createJsonObj( &results.plates[i] );
-      cJSON_AddItemToArray(jsonResults, resultObj);
+      cJSON *stage_object, *buckets;
+      stage_object = cJSON_CreateObject();
+      cJSON_AddStringToObject(stage_object, "stage", stats.stages[i].stage.c_str());
+      cJSON_AddNumberToObject(stage_object, "count", stats.stages[i].count);
+      cJSON_AddNumberToObject(stage_object, "total_ms", stats.stages[i].total_ms);
+      cJSON_AddNumberToObject(stage_object, "max_ms", stats.stages[i].max_ms);
+
+      cJSON_AddItemToObject(stage_object, "buckets", buckets=cJSON_CreateArray());
+      for (unsigned int b = 0; b < stats.stages[i].buckets.size(); b++)
+        cJSON_AddItemToArray(buckets, cJSON_CreateNumber(stats.stages[i].buckets[b]));
+
+      cJSON_AddItemToArray(stages, stage_object);
     }
 
-    // Print the JSON object to a string and return
+    cJSON_AddItemToObject(root, "counters", counters=cJSON_CreateObject());
+    for (unsigned int i = 0; i < stats.counters.size(); i++)
+      cJSON_AddNumberToObject(counters, stats.counters[i].name.c_str(), stats.counters[i].value);
+
+    cJSON_AddItemToObject(root, "rejections", rejections=cJSON_CreateObject());
+    for (unsigned int i = 0; i < stats.rejections.size(); i++)
+      cJSON_AddNumberToObject(rejections, stats.rejections[i].stage.c_str(), stats.rejections[i].rejected);
+
     char *out;
     out=cJSON_PrintUnformatted(root);
 
@@ -565,66 +952,14 @@ namespace alpr
     return response;
   }
 
-
-
   std::string AlprImpl::toJson( const AlprPlateResult result )
   {
-    cJSON *resultObj = createJsonObj( &result );
-    
-    char *out;
-    out=cJSON_PrintUnformatted(resultObj);
-
-    cJSON_Delete(resultObj);
+    JsonWriter writer;
+    writer.beginObject();
+    writer.addPlateResultFields(result);
+    writer.endObject();
 
-    string response(out);
-
-    free(out);
-    
-    return response;
-  }
-  cJSON* AlprImpl::createJsonObj(const AlprPlateResult* result)
-  {
-    cJSON *root, *coords, *candidates;
-
-    root=cJSON_CreateObject();
-
-    cJSON_AddStringToObject(root,"plate",		result->bestPlate.characters.c_str());
-    cJSON_AddNumberToObject(root,"confidence",		result->bestPlate.overall_confidence);
-    cJSON_AddNumberToObject(root,"matches_template",	result->bestPlate.matches_template);
-
-    cJSON_AddNumberToObject(root,"plate_index",               result->plate_index);
-
-    cJSON_AddStringToObject(root,"region",		result->region.c_str());
-    cJSON_AddNumberToObject(root,"region_confidence",	result->regionConfidence);
-
-    cJSON_AddNumberToObject(root,"processing_time_ms",	result->processing_time_ms);
-    cJSON_AddNumberToObject(root,"requested_topn",	result->requested_topn);
-
-    cJSON_AddItemToObject(root, "coordinates", 		coords=cJSON_CreateArray());
-    for (int i=0;i<4;i++)
-    {
-      cJSON *coords_object;
-      coords_object = cJSON_CreateObject();
-      cJSON_AddNumberToObject(coords_object, "x",  result->plate_points[i].x);
-      cJSON_AddNumberToObject(coords_object, "y",  result->plate_points[i].y);
-
-      cJSON_AddItemToArray(coords, coords_object);
-    }
-
-
-    cJSON_AddItemToObject(root, "candidates", 		candidates=cJSON_CreateArray());
-    for (unsigned int i = 0; i < result->topNPlates.size(); i++)
-    {
-      cJSON *candidate_object;
-      candidate_object = cJSON_CreateObject();
-      cJSON_AddStringToObject(candidate_object, "plate",  result->topNPlates[i].characters.c_str());
-      cJSON_AddNumberToObject(candidate_object, "confidence",  result->topNPlates[i].overall_confidence);
-      cJSON_AddNumberToObject(candidate_object, "matches_template",  result->topNPlates[i].matches_template);
-
-      cJSON_AddItemToArray(candidates, candidate_object);
-    }
-
-    return root;
+    return writer.str();
   }
 
   AlprResults AlprImpl::fromJson(std::string json) {
@@ -638,6 +973,10 @@ namespace alpr
     allResults.img_height = cJSON_GetObjectItem(root, "img_height")->valueint;
     allResults.total_processing_time_ms = cJSON_GetObjectItem(root, "processing_time_ms")->valueint;
 
+    cJSON* frameNumber = cJSON_GetObjectItem(root, "frame_number");
+    if (frameNumber != NULL)
+      allResults.frame_number = (int64_t) frameNumber->valuedouble;
+
 
     cJSON* rois = cJSON_GetObjectItem(root,"regions_of_interest");
     int numRois = cJSON_GetArraySize(rois);
@@ -701,6 +1040,17 @@ namespace alpr
       allResults.plates.push_back(plate);
     }
 
+    cJSON* stageTimes = cJSON_GetObjectItem(root, "stage_times_ms");
+    if (stageTimes != NULL)
+    {
+      for (cJSON* stageTime = stageTimes->child; stageTime != NULL; stageTime = stageTime->next)
+      {
+        AlprStageTime stage_time;
+        stage_time.stage = stageTime->string;
+        stage_time.time_ms = stageTime->valuedouble;
+        allResults.stage_times.push_back(stage_time);
+      }
+    }
 
     cJSON_Delete(root);
 
@@ -708,6 +1058,30 @@ namespace alpr
     return allResults;
   }
 
+  std::string AlprImpl::toBinary( const AlprResults results )
+  {
+    BinaryWriter writer;
+    writer.beginRecord(results);
+    writer.endRecord();
+
+    return writer.str();
+  }
+
+  AlprResults AlprImpl::fromBinary(std::string data)
+  {
+    BinaryRecord record;
+    BinaryReader reader(data);
+    if (reader.next(&record) && record.type == BINARY_RECORD_RESULTS)
+      return record.results;
+
+    AlprResults empty;
+    empty.epoch_time = 0;
+    empty.img_width = 0;
+    empty.img_height = 0;
+    empty.total_processing_time_ms = 0;
+    return empty;
+  }
+
   void AlprImpl::setCountry(std::string country) {
     config->load_countries(country);
     loadRecognizers();
@@ -731,7 +1105,7 @@ namespace alpr
 
       typedef std::map<std::string, AlprRecognizers>::iterator it_type;
       for (it_type iterator = recognizers.begin(); iterator != recognizers.end(); iterator++)
-        iterator->second.plateDetector->setMask(mask);
+        iterator->second.detectorPool->setMask(mask);
     }
     catch (cv::Exception& e)
     {
@@ -741,6 +1115,20 @@ namespace alpr
 
 
 
+  void AlprImpl::setNumThreads(int numThreads)
+  {
+    // Zero means "use the configured value"
+    if (numThreads <= 0)
+      numThreads = config->plateAnalysisThreads;
+
+    delete threadPool;
+    threadPool = ALPR_NULL_PTR;
+
+    // The calling thread also works through the queue while it waits, so it counts as one of the threads
+    if (numThreads > 1)
+      threadPool = new ThreadPool(numThreads - 1);
+  }
+
   void AlprImpl::setDetectRegion(bool detectRegion)
   {
 
@@ -775,14 +1163,10 @@ namespace alpr
       {
         // Country training data has not already been loaded.  Load it.
         AlprRecognizers recognizer;
-        recognizer.plateDetector = createDetector(config, prewarp);
-        recognizer.ocr = createOcr(config);
-
-        #ifndef SKIP_STATE_DETECTION
-        recognizer.stateDetector = new StateDetector(this->config->country, this->config->config_file_path, this->config->runtimeBaseDir);
-        #else
-        recognizer.stateDetector = NULL;
-        #endif
+        recognizer.config = new Config(*config);
+        recognizer.detectorPool = new DetectorPool(recognizer.config, prewarp, config->plateAnalysisThreads);
+        recognizer.plateDetector = recognizer.detectorPool->primary();
+        recognizer.models = ModelBundle::acquire(recognizer.config);
 
         recognizers[config->country] = recognizer;
       }
@@ -791,6 +1175,21 @@ namespace alpr
   }
 
   
+  void AlprImpl::refreshCountryConfigs()
+  {
+    // Pick up any changes made to the shared config (e.g., debug settings).  The recognizers
+    // hold pointers to these configs, so update them in place.  The country values were parsed
+    // when the country was loaded and are kept, so the country files aren't read for every image
+    for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
+    {
+      Config* country_config = recognizers.find(config->loaded_countries[i])->second.config;
+
+      Config country_values(*country_config);
+      *country_config = *config;
+      country_config->copyCountryValues(country_values);
+    }
+  }
+
   cv::Mat AlprImpl::getCharacterTransformMatrix(PipelineData* pipeline_data ) {
     std::vector<Point2f> crop_corners;
     crop_corners.push_back(Point2f(0,0));
@@ -804,7 +1203,7 @@ namespace alpr
     return transmtx;
   }
 
-  std::vector<AlprCoordinate> AlprImpl::getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx ) {
+  std::vector<AlprCoordinate> AlprImpl::getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx, PreWarp* imagePrewarp ) {
 
 
     std::vector<Point2f> points;
@@ -816,7 +1215,7 @@ namespace alpr
     cv::perspectiveTransform(points, points, transmtx);
 
     // If using prewarp, remap the points to the original image
-    points = prewarp->projectPoints(points, true);
+    points = imagePrewarp->projectPoints(points, true);
 
 
     std::vector<AlprCoordinate> cornersvector;
@@ -833,3 +1232,49 @@ namespace alpr
 
 
 }
+
+void plateAnalysisThread(void* arg)
+{
+  alpr::PlateAnalysisTask* task = (alpr::PlateAnalysisTask*) arg;
+
+  try
+  {
+    task->impl->analyzePlateRegion(task);
+  }
+  catch (cv::Exception& e)
+  {
+    task->plateDetected = false;
+    task->failed = true;
+    task->error = e;
+  }
+}
+
+void countryPassThread(void* arg)
+{
+  alpr::CountryPassTask* task = (alpr::CountryPassTask*) arg;
+
+  try
+  {
+    task->impl->analyzeCountryPass(task);
+  }
+  catch (cv::Exception& e)
+  {
+    task->failed = true;
+    task->error = e;
+  }
+}
+
+void batchPrepareThread(void* arg)
+{
+  alpr::BatchImageTask* task = (alpr::BatchImageTask*) arg;
+
+  try
+  {
+    task->impl->prepareBatchImage(task);
+  }
+  catch (cv::Exception& e)
+  {
+    std::cerr << "Caught exception in OpenALPR recognizeBatch: " << e.msg << std::endl;
+    task->img = cv::Mat();
+  }
+}
@@ -22,6 +22,7 @@
 #define OPENALPR_ALPRIMPL_H
 
 #include <list>
+#include <map>
 #include <sstream>
 #include <vector>
 #include <queue>
@@ -31,6 +32,7 @@
 
 #include "detection/detector.h"
 #include "detection/detectorfactory.h"
+#include "detection/detectorpool.h"
 
 #include "prewarp.h"
 
@@ -38,12 +40,15 @@
 #include "../statedetection/state_detector.h"
 #include "ocr/ocr.h"
 #include "ocr/ocrfactory.h"
+#include "modelbundle.h"
 
 #include "constants.h"
 
 #include "cjson.h"
 
 #include "pipeline_data.h"
+#include "stage_stats.h"
+#include "mat_arena.h"
 
 #include "prewarp.h"
 
@@ -51,6 +56,8 @@
    
 #include "support/platform.h"
 #include "support/utf8.h"
+#include "support/threadpool.h"
+#include "support/tinythread.h"
 
 #define DEFAULT_TOPN 25
 #define DEFAULT_DETECT_REGION false
@@ -68,9 +75,99 @@ namespace alpr
 
   struct AlprRecognizers
   {
+    // Copy of the shared config with this country's values loaded
+    Config* config;
+
+    DetectorPool* detectorPool;
+
+    // The pool's primary instance.  Owned by detectorPool
     Detector* plateDetector;
-    StateDetector* stateDetector;
-    OCR* ocr;
+
+    // OCR engines and state detection, shared with other Alpr instances
+    ModelBundle* models;
+  };
+
+  class AlprImpl;
+  class ResultAggregator;
+
+  // A single plate region analyzed (possibly on a worker thread) by AlprImpl::analyzePlateRegion
+  struct PlateAnalysisTask
+  {
+    AlprImpl* impl;
+    AlprRecognizers* recognizers;
+    PreWarp* prewarp;
+
+    cv::Mat colorImg;
+    cv::Mat grayImg;
+    PlateRegion plateRegion;
+
+    // The image's stage times
+    StageTimes* stageTimes;
+
+    bool plateDetected;
+    AlprPlateResult plateResult;
+
+    // Set when the analysis threw on a worker thread.  Rethrown on the thread that waits for it
+    bool failed;
+    cv::Exception error;
+  };
+
+  // One of the analysis_count iterations over an image for a single country
+  struct CountryPassTask
+  {
+    AlprImpl* impl;
+    std::string country;
+    int iteration;
+
+    // Supplies the iteration's imperceptible change.  Shared by the country's passes
+    ResultAggregator* iterAggregator;
+
+    // The iteration's image and detector inputs.  Shared by every country's pass for the iteration
+    DetectionContext* detectionContext;
+
+    // The image's stage times.  Shared by every pass over the image
+    StageTimes* stageTimes;
+
+    cv::Mat colorImg;
+    cv::Mat grayImg;
+    std::vector<cv::Rect> warpedRegionsOfInterest;
+    PreWarp* prewarp;
+
+    AlprFullDetails results;
+
+    // Set when the pass threw.  Rethrown (or reported) once every pass over the image is done
+    bool failed;
+    cv::Exception error;
+  };
+
+  // Every country/iteration pass over one image.  The passes are ordered by country, then iteration
+  struct ImagePasses
+  {
+    ImagePasses() : stageTimes(NULL) {}
+
+    StageTimes* stageTimes;
+    std::vector<ResultAggregator*> iterAggregators;
+    std::vector<DetectionContext*> detectionContexts;
+    std::vector<CountryPassTask> passes;
+  };
+
+  // One image of a batch.  It is decoded and warped once, then analyzed for each loaded country
+  struct BatchImageTask
+  {
+    AlprImpl* impl;
+
+    const std::vector<char>* imageBytes;
+
+    cv::Mat img;
+    cv::Mat grayImg;
+    std::vector<cv::Rect> regionsOfInterest;
+    std::vector<cv::Rect> warpedRegionsOfInterest;
+
+    // Warping an image updates the transform, so each image in flight gets its own copy
+    PreWarp* prewarp;
+
+    int64_t start_time;
+    ImagePasses imagePasses;
   };
 
   class AlprImpl
@@ -88,7 +185,16 @@ namespace alpr
       AlprResults recognize( cv::Mat img );
       AlprResults recognize( cv::Mat img, std::vector<cv::Rect> regionsOfInterest );
 
-      AlprFullDetails analyzeSingleCountry(cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> regionsOfInterest);
+      std::vector<AlprResults> recognizeBatch( std::vector<std::vector<char> > imageBytes );
+
+      AlprFullDetails analyzeSingleCountry(std::string country, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> regionsOfInterest, PreWarp* imagePrewarp, DetectionContext* detectionContext,
+                                           StageTimes* stageTimes);
+      void analyzeCountryPass(CountryPassTask* task);
+      void analyzePlateRegion(PlateAnalysisTask* task);
+      MatArena* acquireArena();
+      void releaseArena(MatArena* arena);
+
+      void prepareBatchImage(BatchImageTask* task);
 
       void setCountry(std::string country);
       void setPrewarp(std::string prewarp_config);
@@ -100,33 +206,73 @@ namespace alpr
 
       static std::string toJson( const AlprResults results );
       static std::string toJson( const AlprPlateResult result );
+      static std::string toJson( const AlprStats stats );
       
       static AlprResults fromJson(std::string json);
-      static std::string getVersion();
 
-      static cJSON* createJsonObj(const AlprPlateResult* result);
+      static std::string toBinary( const AlprResults results );
+      static AlprResults fromBinary(std::string data);
+      static std::string getVersion();
       
       Config* config;
 
       bool isLoaded();
 
+      std::vector<AlprStageCount> getRejectionCounts();
+      AlprStats getStats();
+
     private:
 
       std::map<std::string, AlprRecognizers> recognizers;
 
       PreWarp* prewarp;
 
+      // Shared by plate analysis and batch recognition.  NULL when everything runs on the calling thread
+      ThreadPool* threadPool;
+
       int topN;
       bool detectRegion;
       std::string defaultRegion;
 
+      // Stage times, plate counts and rejections for every image processed.  Updated by the analysis threads
+      StageStats stageStats;
+
+      // Images reused from one plate to the next.  NULL when plate_buffers is 0
+      MatArenaPool* arenaPool;
+
       void loadRecognizers();
+      void refreshCountryConfigs();
+      void setNumThreads(int numThreads);
+
+      void createCountryPasses(ImagePasses* imagePasses, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest, PreWarp* imagePrewarp);
+      void runCountryPasses(ImagePasses* imagePasses, TaskGroup* taskGroup);
+      AlprFullDetails aggregateCountryPasses(ImagePasses* imagePasses, int64_t start_time, int img_width, int img_height, std::vector<AlprRegionOfInterest> regionsOfInterest);
+      bool countryPassFailed(ImagePasses* imagePasses, cv::Exception* error);
+      void releaseCountryPasses(ImagePasses* imagePasses);
       
       cv::Mat getCharacterTransformMatrix(PipelineData* pipeline_data );
-      std::vector<AlprCoordinate> getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx);
+      std::vector<AlprCoordinate> getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx, PreWarp* imagePrewarp);
       std::vector<cv::Rect> convertRects(std::vector<AlprRegionOfInterest> regionsOfInterest);
 
   };
+
+  // Borrows a plate's arena for the life of the guard, so it goes back to the pool even if analysis throws
+  class ArenaGuard
+  {
+    public:
+      ArenaGuard(AlprImpl* alpr);
+      virtual ~ArenaGuard();
+
+      // NULL when plate_buffers is 0
+      MatArena* get();
+
+    private:
+      AlprImpl* alpr;
+      MatArena* arena;
+
+      ArenaGuard(const ArenaGuard&);
+      ArenaGuard& operator=(const ArenaGuard&);
+  };
 }
 
 
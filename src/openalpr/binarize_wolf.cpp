@@ -33,6 +33,8 @@
 
 #include "binarize_wolf.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace cv;
 
@@ -213,4 +215,147 @@ void NiblackSauvolaWolfJolion (Mat im, Mat output, NiblackVersion version,
     	}
     }
   }
-}
\ No newline at end of file
+
+  ThresholdSettings thresholdSettings(NiblackVersion version, int winx, int winy, double k, double dR)
+  {
+    ThresholdSettings settings;
+    settings.version = version;
+    settings.winx = winx;
+    settings.winy = winy;
+    settings.k = k;
+    settings.dR = dR;
+    return settings;
+  }
+
+  /**********************************************************
+   * The threshold surface for one setting, using shared integral images.
+   * Only the rows where the window fits inside the image are stored.  The
+   * rows above and below reuse the first and last of them, as do the border
+   * columns in NiblackSauvolaWolfJolion.
+   **********************************************************/
+
+  static Mat thresholdSurface (const Mat& im_sum, const Mat& im_sum_sq, int cols, double min_I,
+                               const ThresholdSettings& settings) {
+    int winx = settings.winx;
+    int winy = settings.winy;
+    int wxh = winx/2;
+    int x_lastth = cols-wxh-1;
+    int window_rows = (im_sum.rows-1) - 2*(winy/2);
+    int window_cols = cols-winx+1;
+    double winarea = winx*winy;
+
+    // Local statistics, stored as floats like calcLocalStats does
+    Mat map_m (window_rows, window_cols, CV_32F);
+    Mat map_s (window_rows, window_cols, CV_32F);
+    double max_s = 0;
+
+    for (int j = 0; j < window_rows; j++) {
+      const double* sum_top = im_sum.ptr<double>(j);
+      const double* sum_bottom = im_sum.ptr<double>(j+winy);
+      const double* sq_top = im_sum_sq.ptr<double>(j);
+      const double* sq_bottom = im_sum_sq.ptr<double>(j+winy);
+      float* m_row = map_m.ptr<float>(j);
+      float* s_row = map_s.ptr<float>(j);
+
+      for (int i = 0; i < window_cols; i++) {
+        double sum = sum_bottom[i+winx] - sum_top[i+winx] - sum_bottom[i] + sum_top[i];
+        double sum_sq = sq_bottom[i+winx] - sq_top[i+winx] - sq_bottom[i] + sq_top[i];
+
+        double m = sum / winarea;
+        double s = sqrt ((sum_sq - m*sum)/winarea);
+        if (s > max_s) max_s = s;
+
+        m_row[i] = m;
+        s_row[i] = s;
+      }
+    }
+
+    Mat thsurf (window_rows, cols, CV_32F);
+
+    for (int j = 0; j < window_rows; j++) {
+      const float* m_row = map_m.ptr<float>(j);
+      const float* s_row = map_s.ptr<float>(j);
+      float* th_row = thsurf.ptr<float>(j);
+
+      for (int i = 0; i < window_cols; i++) {
+        double m = m_row[i];
+        double s = s_row[i];
+        double th;
+
+        switch (settings.version) {
+          case NIBLACK:
+            th = m + settings.k*s;
+            break;
+          case SAUVOLA:
+            th = m * (1 + settings.k*(s/settings.dR-1));
+            break;
+          case WOLFJOLION:
+            th = m + settings.k * (s/max_s-1) * (m-min_I);
+            break;
+          default:
+            cerr << "Unknown threshold type in ImageThresholder::surfaceNiblackImproved()\n";
+            exit (1);
+        }
+
+        th_row[i+wxh] = th;
+      }
+
+      // LEFT and RIGHT BORDERS
+      float first_th = th_row[wxh];
+      float last_th = th_row[window_cols-1+wxh];
+      for (int i = 0; i < wxh; i++)
+        th_row[i] = first_th;
+      for (int i = x_lastth; i < cols; i++)
+        th_row[i] = last_th;
+    }
+
+    return thsurf;
+  }
+
+  void NiblackSauvolaWolfJolion (Mat im, vector<Mat>& outputs, const vector<ThresholdSettings>& settings,
+                                 bool invert) {
+    outputs.resize(settings.size());
+    for (unsigned int t = 0; t < settings.size(); t++)
+      outputs[t].create(im.size(), CV_8U);
+
+    if (im.rows == 0 || im.cols == 0)
+      return;
+
+    Mat im_sum, im_sum_sq;
+    cv::integral(im, im_sum, im_sum_sq, CV_64F);
+
+    double min_I, max_I;
+    minMaxLoc(im, &min_I, &max_I);
+
+    vector<Mat> surfaces(settings.size());
+    vector<int> first_rows(settings.size());
+    for (unsigned int t = 0; t < settings.size(); t++) {
+      // Shrink windows that don't fit in the image.  An image that small would
+      // otherwise have no threshold surface at all
+      ThresholdSettings fitted = settings[t];
+      fitted.winx = std::max(1, std::min(fitted.winx, im.cols - (1 - im.cols % 2)));
+      fitted.winy = std::max(1, std::min(fitted.winy, im.rows - (1 - im.rows % 2)));
+
+      surfaces[t] = thresholdSurface(im_sum, im_sum_sq, im.cols, min_I, fitted);
+      first_rows[t] = fitted.winy/2;
+    }
+
+    unsigned char above = invert ? 0 : 255;
+    unsigned char below = invert ? 255 : 0;
+
+    // One pass over the image writes every output.  The inner loop is a straight
+    // compare of two contiguous rows, which compilers vectorize
+    for (int y = 0; y < im.rows; y++) {
+      const unsigned char* im_row = im.ptr<unsigned char>(y);
+
+      for (unsigned int t = 0; t < settings.size(); t++) {
+        int surface_row = std::min(std::max(y-first_rows[t], 0), surfaces[t].rows-1);
+        const float* th_row = surfaces[t].ptr<float>(surface_row);
+        unsigned char* out_row = outputs[t].ptr<unsigned char>(y);
+
+        for (int x = 0; x < im.cols; x++)
+          out_row[x] = (im_row[x] >= th_row[x]) ? above : below;
+      }
+    }
+  }
+}
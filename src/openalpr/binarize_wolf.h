@@ -20,6 +20,8 @@
 #ifndef OPENALPR_BINARIZEWOLF_H
 #define OPENALPR_BINARIZEWOLF_H
 
+#include <vector>
+
 #include "support/filesystem.h"
 
 #include "opencv2/opencv.hpp"
@@ -45,6 +47,23 @@ namespace alpr
   void NiblackSauvolaWolfJolion (cv::Mat im, cv::Mat output, NiblackVersion version,
                                  int winx, int winy, double k, double dR=BINARIZEWOLF_DEFAULTDR);
 
+  struct ThresholdSettings
+  {
+    NiblackVersion version;
+    int winx;
+    int winy;
+    double k;
+    double dR;
+  };
+
+  ThresholdSettings thresholdSettings(NiblackVersion version, int winx, int winy, double k, double dR=BINARIZEWOLF_DEFAULTDR);
+
+  // Produces the same images as calling NiblackSauvolaWolfJolion once per setting, but computes the
+  // integral images once for all of them.  Each output is CV_8U.  Outputs that already have that size
+  // and type are written in place.  When invert is set, the outputs come out as if passed through bitwise_not
+  void NiblackSauvolaWolfJolion (cv::Mat im, std::vector<cv::Mat>& outputs, const std::vector<ThresholdSettings>& settings,
+                                 bool invert);
+
 }
 
 #endif // OPENALPR_BINARIZEWOLF_H
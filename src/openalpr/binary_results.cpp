@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "binary_results.h"
+
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+namespace alpr
+{
+
+  const char BINARY_MAGIC[] = "ALPR";
+  const int BINARY_MAGIC_SIZE = 4;
+
+  const int BINARY_FIELD_END = 0;
+  const int BINARY_FIELD_STRING = 1;
+  const int BINARY_FIELD_INT = 2;
+
+  BinaryWriter::BinaryWriter()
+  {
+    record_start = 0;
+  }
+
+  BinaryWriter::~BinaryWriter()
+  {
+  }
+
+  void BinaryWriter::clear()
+  {
+    buffer.clear();
+  }
+
+  const std::string& BinaryWriter::str() const
+  {
+    return buffer;
+  }
+
+  void BinaryWriter::beginRecord(const AlprResults& results)
+  {
+    beginHeader(BINARY_RECORD_RESULTS);
+
+    writeInt(results.epoch_time);
+    writeInt(results.frame_number);
+    writeInt(results.img_width);
+    writeInt(results.img_height);
+    writeFloat(results.total_processing_time_ms);
+
+    writeInt(results.regionsOfInterest.size());
+    for (unsigned int i = 0; i < results.regionsOfInterest.size(); i++)
+    {
+      writeInt(results.regionsOfInterest[i].x);
+      writeInt(results.regionsOfInterest[i].y);
+      writeInt(results.regionsOfInterest[i].width);
+      writeInt(results.regionsOfInterest[i].height);
+    }
+
+    writeInt(results.plates.size());
+    for (unsigned int i = 0; i < results.plates.size(); i++)
+      writePlateResult(results.plates[i]);
+
+    writeInt(results.stage_times.size());
+    for (unsigned int i = 0; i < results.stage_times.size(); i++)
+    {
+      writeString(results.stage_times[i].stage);
+      writeFloat(results.stage_times[i].time_ms);
+    }
+  }
+
+  void BinaryWriter::beginRecord(const AlprPlateResult& result)
+  {
+    beginHeader(BINARY_RECORD_PLATE_RESULT);
+    writePlateResult(result);
+  }
+
+  void BinaryWriter::addField(const std::string& name, const std::string& value)
+  {
+    buffer += (char) BINARY_FIELD_STRING;
+    writeString(name);
+    writeString(value);
+  }
+
+  void BinaryWriter::addField(const std::string& name, int64_t value)
+  {
+    buffer += (char) BINARY_FIELD_INT;
+    writeString(name);
+    writeInt(value);
+  }
+
+  void BinaryWriter::endRecord()
+  {
+    buffer += (char) BINARY_FIELD_END;
+
+    uint32_t length = buffer.size() - record_start - 4;
+    for (int i = 0; i < 4; i++)
+      buffer[record_start + i] = (char) ((length >> (i * 8)) & 0xFF);
+  }
+
+  void BinaryWriter::beginHeader(BinaryRecordType type)
+  {
+    record_start = buffer.size();
+
+    // The length is filled in by endRecord()
+    buffer.append(4, '\0');
+    buffer.append(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+    buffer += (char) BINARY_RESULTS_VERSION;
+    buffer += (char) type;
+  }
+
+  void BinaryWriter::writePlateResult(const AlprPlateResult& result)
+  {
+    writeInt(result.plate_index);
+    writeInt(result.regionConfidence);
+    writeString(result.region);
+    writeFloat(result.processing_time_ms);
+    writeInt(result.requested_topn);
+
+    for (int i = 0; i < 4; i++)
+    {
+      writeInt(result.plate_points[i].x);
+      writeInt(result.plate_points[i].y);
+    }
+
+    writeInt(result.topNPlates.size());
+    for (unsigned int i = 0; i < result.topNPlates.size(); i++)
+      writePlate(result.topNPlates[i]);
+
+    // The best plate is nearly always the first candidate.  Only send it separately when it isn't
+    bool best_is_first = result.topNPlates.size() > 0 &&
+                         result.topNPlates[0].characters == result.bestPlate.characters &&
+                         result.topNPlates[0].overall_confidence == result.bestPlate.overall_confidence &&
+                         result.topNPlates[0].matches_template == result.bestPlate.matches_template;
+    buffer += (char) (best_is_first ? 1 : 0);
+    if (!best_is_first)
+      writePlate(result.bestPlate);
+  }
+
+  void BinaryWriter::writePlate(const AlprPlate& plate)
+  {
+    writeString(plate.characters);
+    writeFloat(plate.overall_confidence);
+    buffer += (char) (plate.matches_template ? 1 : 0);
+  }
+
+  // Zigzag encoding keeps small negative numbers small
+  void BinaryWriter::writeInt(int64_t value)
+  {
+    uint64_t encoded = (((uint64_t) value) << 1) ^ (uint64_t) (value >> 63);
+
+    while (encoded >= 0x80)
+    {
+      buffer += (char) ((encoded & 0x7F) | 0x80);
+      encoded >>= 7;
+    }
+    buffer += (char) encoded;
+  }
+
+  void BinaryWriter::writeFloat(float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    for (int i = 0; i < 4; i++)
+      buffer += (char) ((bits >> (i * 8)) & 0xFF);
+  }
+
+  void BinaryWriter::writeString(const std::string& value)
+  {
+    writeInt(value.size());
+    buffer += value;
+  }
+
+  BinaryReader::BinaryReader(const std::string& data)
+    : data(data)
+  {
+    position = 0;
+    record_end = 0;
+  }
+
+  BinaryReader::~BinaryReader()
+  {
+  }
+
+  bool BinaryReader::next(BinaryRecord* record)
+  {
+    if (position + 4 > data.size())
+      return false;
+
+    uint32_t length = 0;
+    for (int i = 0; i < 4; i++)
+      length |= ((uint32_t) (unsigned char) data[position + i]) << (i * 8);
+    position += 4;
+
+    // Give up on the rest of the data after a bad record, since there's no telling where the next one starts
+    record_end = position + length;
+    if (length < BINARY_MAGIC_SIZE + 2 || record_end > data.size() ||
+        data.compare(position, BINARY_MAGIC_SIZE, BINARY_MAGIC) != 0)
+    {
+      position = data.size();
+      return false;
+    }
+    position += BINARY_MAGIC_SIZE;
+
+    int version, type;
+    readByte(&version);
+    readByte(&type);
+
+    record->results = AlprResults();
+    record->plate = AlprPlateResult();
+    record->string_fields.clear();
+    record->int_fields.clear();
+
+    bool valid = version >= 1 && version <= BINARY_RESULTS_VERSION;
+    if (valid && type == BINARY_RECORD_RESULTS)
+    {
+      AlprResults* results = &record->results;
+      int count;
+
+      valid = readInt(&results->epoch_time) && readInt(&results->frame_number) &&
+              readInt(&results->img_width) && readInt(&results->img_height) &&
+              readFloat(&results->total_processing_time_ms) && readCount(&count);
+
+      for (int i = 0; valid && i < count; i++)
+      {
+        int x, y, width, height;
+        valid = readInt(&x) && readInt(&y) && readInt(&width) && readInt(&height);
+        results->regionsOfInterest.push_back(AlprRegionOfInterest(x, y, width, height));
+      }
+
+      valid = valid && readCount(&count);
+      for (int i = 0; valid && i < count; i++)
+      {
+        results->plates.push_back(AlprPlateResult());
+        valid = readPlateResult(&results->plates.back());
+      }
+
+      valid = valid && readCount(&count);
+      for (int i = 0; valid && i < count; i++)
+      {
+        AlprStageTime stage_time;
+        valid = readString(&stage_time.stage) && readFloat(&stage_time.time_ms);
+        results->stage_times.push_back(stage_time);
+      }
+    }
+    else if (valid && type == BINARY_RECORD_PLATE_RESULT)
+    {
+      valid = readPlateResult(&record->plate);
+    }
+    else
+    {
+      valid = false;
+    }
+    record->type = (BinaryRecordType) type;
+
+    while (valid)
+    {
+      int kind;
+      string name;
+      valid = readByte(&kind);
+      if (!valid || kind == BINARY_FIELD_END)
+        break;
+
+      valid = readString(&name);
+      if (valid && kind == BINARY_FIELD_STRING)
+        valid = readString(&record->string_fields[name]);
+      else if (valid && kind == BINARY_FIELD_INT)
+        valid = readInt(&record->int_fields[name]);
+      else
+        valid = false;
+    }
+
+    if (!valid)
+    {
+      position = data.size();
+      return false;
+    }
+
+    position = record_end;
+    return true;
+  }
+
+  bool BinaryReader::readPlateResult(AlprPlateResult* result)
+  {
+    int count, best_is_first;
+
+    if (!readInt(&result->plate_index) || !readInt(&result->regionConfidence) || !readString(&result->region) ||
+        !readFloat(&result->processing_time_ms) || !readInt(&result->requested_topn))
+      return false;
+
+    for (int i = 0; i < 4; i++)
+    {
+      if (!readInt(&result->plate_points[i].x) || !readInt(&result->plate_points[i].y))
+        return false;
+    }
+
+    if (!readCount(&count))
+      return false;
+
+    for (int i = 0; i < count; i++)
+    {
+      result->topNPlates.push_back(AlprPlate());
+      if (!readPlate(&result->topNPlates.back()))
+        return false;
+    }
+
+    if (!readByte(&best_is_first))
+      return false;
+
+    if (best_is_first && count > 0)
+      result->bestPlate = result->topNPlates[0];
+    else if (!readPlate(&result->bestPlate))
+      return false;
+
+    return true;
+  }
+
+  bool BinaryReader::readPlate(AlprPlate* plate)
+  {
+    int matches_template;
+    if (!readString(&plate->characters) || !readFloat(&plate->overall_confidence) || !readByte(&matches_template))
+      return false;
+
+    plate->matches_template = matches_template != 0;
+    return true;
+  }
+
+  bool BinaryReader::readByte(int* value)
+  {
+    if (position >= record_end)
+      return false;
+
+    *value = (unsigned char) data[position++];
+    return true;
+  }
+
+  bool BinaryReader::readInt(int64_t* value)
+  {
+    uint64_t encoded = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      int byte;
+      if (!readByte(&byte))
+        return false;
+
+      encoded |= ((uint64_t) (byte & 0x7F)) << shift;
+      if ((byte & 0x80) == 0)
+      {
+        *value = (int64_t) (encoded >> 1) ^ -((int64_t) (encoded & 1));
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool BinaryReader::readInt(int* value)
+  {
+    int64_t wide;
+    if (!readInt(&wide) || wide < INT_MIN || wide > INT_MAX)
+      return false;
+
+    *value = (int) wide;
+    return true;
+  }
+
+  // Every element takes at least a byte, so a count larger than what's left of the record is corrupt
+  bool BinaryReader::readCount(int* value)
+  {
+    if (!readInt(value) || *value < 0 || (size_t) *value > record_end - position)
+      return false;
+
+    return true;
+  }
+
+  bool BinaryReader::readFloat(float* value)
+  {
+    if (position + 4 > record_end)
+      return false;
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++)
+      bits |= ((uint32_t) (unsigned char) data[position + i]) << (i * 8);
+    position += 4;
+
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+  }
+
+  bool BinaryReader::readString(std::string* value)
+  {
+    int length;
+    if (!readCount(&length))
+      return false;
+
+    value->assign(data, position, length);
+    position += length;
+    return true;
+  }
+
+  bool isBinaryRecords(const std::string& data)
+  {
+    size_t position = 0;
+    while (position + 4 <= data.size())
+    {
+      uint32_t length = 0;
+      for (int i = 0; i < 4; i++)
+        length |= ((uint32_t) (unsigned char) data[position + i]) << (i * 8);
+      position += 4;
+
+      if (length < BINARY_MAGIC_SIZE + 2 || length > data.size() - position ||
+          data.compare(position, BINARY_MAGIC_SIZE, BINARY_MAGIC) != 0)
+        return false;
+
+      position += length;
+    }
+
+    return data.size() > 0 && position == data.size();
+  }
+
+}
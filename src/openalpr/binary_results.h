@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_BINARYRESULTS_H
+#define OPENALPR_BINARYRESULTS_H
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include "alpr.h"
+
+// A compact alternative to the JSON results, for sending over slow links.
+//
+// Each record is:
+//   uint32   number of bytes that follow, little endian
+//   4 bytes  "ALPR"
+//   uint8    format version (BINARY_RESULTS_VERSION)
+//   uint8    record type (BinaryRecordType)
+//   ...      AlprResults or AlprPlateResult
+//   ...      extra fields, each a uint8 kind (1 = string, 2 = integer), the name (a string) and the value.
+//            A 0 kind ends the list
+//
+// Integers are zigzag encoded varints, floats are 4 byte IEEE little endian and strings are a
+// byte count (an integer) followed by the UTF-8 bytes.  Records can be concatenated.
+//
+// AlprResults:
+//   int epoch_time, int frame_number, int img_width, int img_height, float processing_time_ms
+//   int count, then each region of interest: int x, int y, int width, int height
+//   int count, then each AlprPlateResult
+//   int count, then each stage time: string stage, float time_ms
+//
+// AlprPlateResult:
+//   int plate_index, int region_confidence, string region, float processing_time_ms, int requested_topn
+//   int x, int y for each of the 4 corners
+//   int count, then each candidate: string plate, float confidence, uint8 matches_template
+//   uint8 1 if the best plate is the first candidate.  Otherwise 0, followed by the best plate as a candidate
+
+namespace alpr
+{
+
+  const int BINARY_RESULTS_VERSION = 1;
+
+  enum BinaryRecordType
+  {
+    BINARY_RECORD_RESULTS = 1,
+    BINARY_RECORD_PLATE_RESULT = 2
+  };
+
+  // Writes binary records into a buffer that is kept between records, like JsonWriter.
+  // Extra fields can be added between beginRecord() and endRecord()
+  class BinaryWriter
+  {
+    public:
+      BinaryWriter();
+      virtual ~BinaryWriter();
+
+      // Empties the buffer.  Records written without a clear() in between are concatenated
+      void clear();
+
+      const std::string& str() const;
+
+      void beginRecord(const AlprResults& results);
+      void beginRecord(const AlprPlateResult& result);
+
+      void addField(const std::string& name, const std::string& value);
+      void addField(const std::string& name, int64_t value);
+
+      void endRecord();
+
+    private:
+
+      std::string buffer;
+
+      // Where the open record's length goes
+      size_t record_start;
+
+      void beginHeader(BinaryRecordType type);
+      void writePlateResult(const AlprPlateResult& result);
+      void writePlate(const AlprPlate& plate);
+
+      void writeInt(int64_t value);
+      void writeFloat(float value);
+      void writeString(const std::string& value);
+  };
+
+  // One decoded record.  Only the member matching the type is filled in
+  struct BinaryRecord
+  {
+    BinaryRecordType type;
+    AlprResults results;
+    AlprPlateResult plate;
+
+    std::map<std::string, std::string> string_fields;
+    std::map<std::string, int64_t> int_fields;
+  };
+
+  // Decodes the records written by BinaryWriter, one at a time
+  class BinaryReader
+  {
+    public:
+      // The data must outlive the reader
+      BinaryReader(const std::string& data);
+      virtual ~BinaryReader();
+
+      // Decodes the next record.  Returns false at the end of the data, or if the record is
+      // truncated, corrupt or from a newer format version
+      bool next(BinaryRecord* record);
+
+    private:
+
+      const std::string& data;
+      size_t position;
+
+      // Where the current record ends
+      size_t record_end;
+
+      bool readPlateResult(AlprPlateResult* result);
+      bool readPlate(AlprPlate* plate);
+
+      bool readByte(int* value);
+      bool readInt(int64_t* value);
+      bool readInt(int* value);
+      bool readCount(int* value);
+      bool readFloat(float* value);
+      bool readString(std::string* value);
+  };
+
+  // True when the data is one or more whole binary records.  Only each record's length and magic
+  // are checked, so this tells binary records apart from JSON (or garbage) without decoding them
+  bool isBinaryRecords(const std::string& data);
+
+}
+
+#endif // OPENALPR_BINARYRESULTS_H
@@ -201,12 +201,58 @@ namespace alpr
     mustMatchPattern = getBoolean(ini, defaultIni, "", "must_match_pattern", false);
     
     skipDetection = getBoolean(ini, defaultIni, "", "skip_detection", false);
+
+    prefilter = getBoolean(ini, defaultIni, "", "prefilter", false);
+    prefilterMinContrast = getFloat(ini, defaultIni, "", "prefilter_min_contrast", 40);
+    prefilterMinStdDev = getFloat(ini, defaultIni, "", "prefilter_min_stddev", 12);
+    prefilterMinEdgeDensity = getFloat(ini, defaultIni, "", "prefilter_min_edge_density", 0.03);
+    prefilterMaxEdgeDensity = getFloat(ini, defaultIni, "", "prefilter_max_edge_density", 0.6);
+
+    plateBuffers = getInt(ini, defaultIni, "", "plate_buffers", 64);
+
+    detectionSchedule = getBoolean(ini, defaultIni, "", "detection_schedule", false);
+    detectionScheduleColumns = getInt(ini, defaultIni, "", "detection_schedule_columns", 2);
+    detectionScheduleRows = getInt(ini, defaultIni, "", "detection_schedule_rows", 2);
+    detectionScheduleFullScanInterval = getInt(ini, defaultIni, "", "detection_schedule_full_scan_interval", 8);
+    detectionScheduleHitTimeoutMs = getInt(ini, defaultIni, "", "detection_schedule_hit_timeout_ms", 2000);
     
     detection_mask_image = getString(ini, defaultIni, "", "detection_mask_image", "");
     
     analysis_count = getInt(ini, defaultIni, "", "analysis_count", 1);
+
+    plateAnalysisThreads = getInt(ini, defaultIni, "", "plate_analysis_threads", 1);
     
     prewarp = getString(ini, defaultIni, "", "prewarp", "");
+
+    std::string prewarpMethodString = getString(ini, defaultIni, "", "prewarp_method", "perspective");
+    std::transform(prewarpMethodString.begin(), prewarpMethodString.end(), prewarpMethodString.begin(), ::tolower);
+
+    if (prewarpMethodString.compare("perspective") == 0)
+      prewarpMethod = PREWARP_PERSPECTIVE;
+    else if (prewarpMethodString.compare("remap") == 0)
+      prewarpMethod = PREWARP_REMAP;
+    else if (prewarpMethodString.compare("remap_roi") == 0)
+      prewarpMethod = PREWARP_REMAP_ROI;
+    else
+    {
+      std::cerr << "Invalid prewarp_method specified: " << prewarpMethodString << ".  Using default" << std::endl;
+      prewarpMethod = PREWARP_PERSPECTIVE;
+    }
+
+    std::string prewarpInterpolationString = getString(ini, defaultIni, "", "prewarp_interpolation", "cubic");
+    std::transform(prewarpInterpolationString.begin(), prewarpInterpolationString.end(), prewarpInterpolationString.begin(), ::tolower);
+
+    if (prewarpInterpolationString.compare("nearest") == 0)
+      prewarpInterpolation = PREWARP_NEAREST;
+    else if (prewarpInterpolationString.compare("linear") == 0)
+      prewarpInterpolation = PREWARP_LINEAR;
+    else if (prewarpInterpolationString.compare("cubic") == 0)
+      prewarpInterpolation = PREWARP_CUBIC;
+    else
+    {
+      std::cerr << "Invalid prewarp_interpolation specified: " << prewarpInterpolationString << ".  Using default" << std::endl;
+      prewarpInterpolation = PREWARP_CUBIC;
+    }
             
     maxPlateAngleDegrees = getInt(ini, defaultIni, "", "max_plate_angle_degrees", 15);
 
@@ -215,10 +261,32 @@ namespace alpr
     stateIdImagePercent = getFloat(ini, defaultIni, "", "state_id_img_size_percent", 100);
 
     ocrMinFontSize = getInt(ini, defaultIni, "", "ocr_min_font_point", 100);
+    ocrBatchLine = getBoolean(ini, defaultIni, "", "ocr_batch_line", false);
+
+    std::string ocrEngineString = getString(ini, defaultIni, "", "ocr_engine", "tesseract");
+    std::transform(ocrEngineString.begin(), ocrEngineString.end(), ocrEngineString.begin(), ::tolower);
+
+    if (ocrEngineString.compare("tesseract") == 0)
+      ocrEngine = OCR_TESSERACT;
+    else if (ocrEngineString.compare("knn") == 0)
+      ocrEngine = OCR_KNN;
+    else
+    {
+      std::cerr << "Invalid OCR engine specified: " << ocrEngineString << ".  Using default" << std::endl;
+      ocrEngine = OCR_TESSERACT;
+    }
+
+    ocrKnnNeighbors = getInt(ini, defaultIni, "", "ocr_knn_neighbors", 5);
+
+    ocrCache = getBoolean(ini, defaultIni, "", "ocr_cache", false);
+    ocrCacheSize = getInt(ini, defaultIni, "", "ocr_cache_size", 256);
+    ocrCacheMaxDistance = getInt(ini, defaultIni, "", "ocr_cache_max_distance", 1);
 
     postProcessMinConfidence = getFloat(ini, defaultIni, "", "postprocess_min_confidence", 100);
     postProcessConfidenceSkipLevel = getFloat(ini, defaultIni, "", "postprocess_confidence_skip_level", 100);
 
+    reportStageTimes = getBoolean(ini, defaultIni, "", "report_stage_times", false);
+
     debugGeneral = 	getBoolean(ini, defaultIni, "", "debug_general",		false);
     debugTiming = 	getBoolean(ini, defaultIni, "", "debug_timing",		false);
     debugPrewarp = 	getBoolean(ini, defaultIni, "", "debug_prewarp",		false);
@@ -320,6 +388,62 @@ namespace alpr
     postProcessMaxCharacters = getInt(ini, "", "postprocess_max_characters", 8);
   }
 
+  void Config::copyCountryValues(const Config& other)
+  {
+    country = other.country;
+
+    minPlateSizeWidthPx = other.minPlateSizeWidthPx;
+    minPlateSizeHeightPx = other.minPlateSizeHeightPx;
+
+    multiline = other.multiline;
+
+    auto_invert = other.auto_invert;
+    always_invert = other.always_invert;
+
+    plateWidthMM = other.plateWidthMM;
+    plateHeightMM = other.plateHeightMM;
+
+    charHeightMM = other.charHeightMM;
+    charWidthMM = other.charWidthMM;
+    avgCharHeightMM = other.avgCharHeightMM;
+    avgCharWidthMM = other.avgCharWidthMM;
+
+    charWhitespaceTopMM = other.charWhitespaceTopMM;
+    charWhitespaceBotMM = other.charWhitespaceBotMM;
+    charWhitespaceBetweenLinesMM = other.charWhitespaceBetweenLinesMM;
+
+    templateWidthPx = other.templateWidthPx;
+    templateHeightPx = other.templateHeightPx;
+
+    charAnalysisMinPercent = other.charAnalysisMinPercent;
+    charAnalysisHeightRange = other.charAnalysisHeightRange;
+    charAnalysisHeightStepSize = other.charAnalysisHeightStepSize;
+    charAnalysisNumSteps = other.charAnalysisNumSteps;
+
+    segmentationMinSpeckleHeightPercent = other.segmentationMinSpeckleHeightPercent;
+    segmentationMinBoxWidthPx = other.segmentationMinBoxWidthPx;
+    segmentationMinCharHeightPercent = other.segmentationMinCharHeightPercent;
+    segmentationMaxCharWidthvsAverage = other.segmentationMaxCharWidthvsAverage;
+
+    plateLinesSensitivityVertical = other.plateLinesSensitivityVertical;
+    plateLinesSensitivityHorizontal = other.plateLinesSensitivityHorizontal;
+
+    detectorFile = other.detectorFile;
+
+    ocrLanguage = other.ocrLanguage;
+
+    postProcessRegexLetters = other.postProcessRegexLetters;
+    postProcessRegexNumbers = other.postProcessRegexNumbers;
+
+    ocrImageWidthPx = other.ocrImageWidthPx;
+    ocrImageHeightPx = other.ocrImageHeightPx;
+    stateIdImageWidthPx = other.stateIdImageWidthPx;
+    stateIdimageHeightPx = other.stateIdimageHeightPx;
+
+    postProcessMinCharacters = other.postProcessMinCharacters;
+    postProcessMaxCharacters = other.postProcessMaxCharacters;
+  }
+
   void Config::setDebug(bool value)
   {
     debugGeneral = value;
@@ -356,6 +480,11 @@ namespace alpr
     return this->runtimeBaseDir + "/ocr/";
   }
 
+  string Config::getCharacterModelFile()
+  {
+    return this->runtimeBaseDir + "/ocr/" + this->ocrLanguage + ".charmodel";
+  }
+
 
   std::vector<std::string> Config::parse_country_string(std::string countries)
   {
@@ -397,7 +526,11 @@ namespace alpr
 
     loadCountryValues(country_config_file, country);
 
-    if (fileExists((this->runtimeBaseDir + "/ocr/tessdata/" + this->ocrLanguage + ".traineddata").c_str()) == false)
+    std::string ocrDataFile = this->runtimeBaseDir + "/ocr/tessdata/" + this->ocrLanguage + ".traineddata";
+    if (ocrEngine == OCR_KNN)
+      ocrDataFile = getCharacterModelFile();
+
+    if (fileExists(ocrDataFile.c_str()) == false)
     {
       std::cerr << "--(!) Runtime directory '" << this->runtimeBaseDir << "' is invalid.  Missing OCR data for the country: '" << country<< "'!" << endl;
       return false;
@@ -57,15 +57,33 @@ namespace alpr
       float contrastDetectionThreshold;
       
       bool skipDetection;
+
+      bool prefilter;
+      float prefilterMinContrast;
+      float prefilterMinStdDev;
+      float prefilterMinEdgeDensity;
+      float prefilterMaxEdgeDensity;
+
+      int plateBuffers;
+
+      bool detectionSchedule;
+      int detectionScheduleColumns;
+      int detectionScheduleRows;
+      int detectionScheduleFullScanInterval;
+      int detectionScheduleHitTimeoutMs;
       
       std::string detection_mask_image;
 
       int analysis_count;
+
+      int plateAnalysisThreads;
       
       bool auto_invert;
       bool always_invert;
 
       std::string prewarp;
+      int prewarpMethod;
+      int prewarpInterpolation;
       
       int maxPlateAngleDegrees;
 
@@ -113,6 +131,13 @@ namespace alpr
       
       std::string ocrLanguage;
       int ocrMinFontSize;
+      bool ocrBatchLine;
+      int ocrEngine;
+      int ocrKnnNeighbors;
+
+      bool ocrCache;
+      int ocrCacheSize;
+      int ocrCacheMaxDistance;
 
       bool mustMatchPattern;
       
@@ -124,6 +149,8 @@ namespace alpr
       std::string postProcessRegexLetters;
       std::string postProcessRegexNumbers;
 
+      bool reportStageTimes;
+
       bool debugGeneral;
       bool debugTiming;
       bool debugPrewarp;
@@ -146,6 +173,7 @@ namespace alpr
       std::string getCascadeRuntimeDir();
       std::string getPostProcessRuntimeDir();
       std::string getTessdataPrefix();
+      std::string getCharacterModelFile();
 
       std::string runtimeBaseDir;
 
@@ -153,6 +181,9 @@ namespace alpr
 
       bool setCountry(std::string country);
 
+      // Copies the values that setCountry loaded from the other config's country file, without reading it again
+      void copyCountryValues(const Config& other);
+
     private:
     
       float ocrImagePercent;
@@ -175,5 +206,25 @@ namespace alpr
     DETECTOR_LBP_OPENCL=3
   };
 
+  enum OCR_ENGINE
+  {
+    OCR_TESSERACT=0,
+    OCR_KNN=1
+  };
+
+  enum PREWARP_METHOD
+  {
+    PREWARP_PERSPECTIVE=0,
+    PREWARP_REMAP=1,
+    PREWARP_REMAP_ROI=2
+  };
+
+  enum PREWARP_INTERPOLATION
+  {
+    PREWARP_NEAREST=0,
+    PREWARP_LINEAR=1,
+    PREWARP_CUBIC=2
+  };
+
 }
 #endif // OPENALPR_CONFIG_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "detectioncontext.h"
+
+using namespace cv;
+using namespace std;
+
+namespace alpr
+{
+
+  DetectionContext::DetectionContext()
+  {
+  }
+
+  DetectionContext::~DetectionContext()
+  {
+  }
+
+  cv::Mat DetectionContext::getFrame()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    return frame;
+  }
+
+  cv::Mat DetectionContext::setFrame(cv::Mat frame)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    if (this->frame.empty())
+      this->frame = frame;
+
+    return this->frame;
+  }
+
+  cv::Mat DetectionContext::getDetectionInput(cv::Mat frame_gray, cv::Rect roi, cv::Size size, bool equalize)
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+      Mat prepared = findInput(roi, size, equalize);
+      if (!prepared.empty())
+        return prepared;
+    }
+
+    // Build the image without holding the lock, so that other passes can pick up the inputs that are ready
+    DetectionInput input;
+    input.roi = roi;
+    input.size = size;
+    input.equalized = equalize;
+
+    Mat cropped = frame_gray(roi);
+    if (cropped.size() != size)
+      resize(cropped, input.image, size);
+    else
+      input.image = cropped;
+
+    if (equalize)
+    {
+      // Equalizing in place would change the caller's frame when no resize was needed
+      Mat equalized;
+      equalizeHist(input.image, equalized);
+      input.image = equalized;
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    // Another pass may have built the same input in the meantime.  Everyone uses the first one
+    Mat prepared = findInput(roi, size, equalize);
+    if (!prepared.empty())
+      return prepared;
+
+    inputs.push_back(input);
+
+    return input.image;
+  }
+
+  // Must be called with the lock held.  Returns an empty Mat if the input hasn't been built
+  cv::Mat DetectionContext::findInput(cv::Rect roi, cv::Size size, bool equalize)
+  {
+    for (unsigned int i = 0; i < inputs.size(); i++)
+    {
+      if (inputs[i].roi == roi && inputs[i].size == size && inputs[i].equalized == equalize)
+        return inputs[i].image;
+    }
+
+    return Mat();
+  }
+
+}
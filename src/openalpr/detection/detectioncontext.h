@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_DETECTIONCONTEXT_H
+#define	OPENALPR_DETECTIONCONTEXT_H
+
+#include <vector>
+
+#include "opencv2/imgproc/imgproc.hpp"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // The detector inputs prepared from one frame: the cropped, resized and (optionally) histogram
+  // equalized region of each ROI.  Every country's detector that scans the frame shares them, so
+  // each is only kept once however many countries are loaded.  Two passes that ask for the same input
+  // at the same moment may both build it, but they both get the first one published.
+  //
+  // Every user of a context must pass it the same pixels.  Thread safe.
+  class DetectionContext
+  {
+    public:
+      DetectionContext();
+      virtual ~DetectionContext();
+
+      // The frame the context was built for, or an empty Mat if no one has set it yet
+      cv::Mat getFrame();
+
+      // Sets the frame unless another thread got there first.  Returns the frame everyone should use
+      cv::Mat setFrame(cv::Mat frame);
+
+      // The region of the (grayscale) frame resized to size, equalized if requested.
+      // The returned image is shared and must not be modified
+      cv::Mat getDetectionInput(cv::Mat frame_gray, cv::Rect roi, cv::Size size, bool equalize);
+
+    private:
+
+      struct DetectionInput
+      {
+        cv::Rect roi;
+        cv::Size size;
+        bool equalized;
+        cv::Mat image;
+      };
+
+      tthread::mutex mMutex;
+      cv::Mat frame;
+      std::vector<DetectionInput> inputs;
+
+      cv::Mat findInput(cv::Rect roi, cv::Size size, bool equalize);
+  };
+
+}
+
+#endif	/* OPENALPR_DETECTIONCONTEXT_H */
@@ -63,6 +63,11 @@ namespace alpr
   }
 
   vector<PlateRegion> Detector::detect(Mat frame, std::vector<cv::Rect> regionsOfInterest)
+  {
+    return this->detect(frame, regionsOfInterest, NULL);
+  }
+
+  vector<PlateRegion> Detector::detect(Mat frame, std::vector<cv::Rect> regionsOfInterest, DetectionContext* context)
   {
 
     Mat frame_gray;
@@ -73,9 +78,14 @@ namespace alpr
     }
     else
     {
-      frame.copyTo(frame_gray);
+      frame_gray = frame;
     }
 
+    // A masked frame belongs to this detector alone
+    DetectionContext localContext;
+    if (context == NULL || detector_mask.mask_loaded)
+      context = &localContext;
+
     // Apply the detection mask if it has been specified by the user
     if (detector_mask.mask_loaded)
       frame_gray = detector_mask.apply_mask(frame_gray);
@@ -88,35 +98,45 @@ namespace alpr
       cvtColor(frame_gray, mask_debug_img, CV_GRAY2BGR);
     }
     
+    // Adjust the ROIs to be inside the detection mask (if it exists)
+    if (detector_mask.mask_loaded)
+    {
+      for (unsigned int i = 0; i < regionsOfInterest.size(); i++)
+      {
+        regionsOfInterest[i] = detector_mask.getRoiInsideMask(regionsOfInterest[i]);
+
+        // Draw ROIs on debug mask image
+        if (config->debugDetector)
+          rectangle(mask_debug_img, regionsOfInterest[i], Scalar(0,255,255), 3);
+      }
+    }
+
+    // Skip ROIs that another ROI already covers.  Partly overlapping ones are scanned separately, since
+    // scanning their union would search outside them and at a coarser scale
+    regionsOfInterest = removeContainedRects(regionsOfInterest);
+
     vector<PlateRegion> detectedRegions;   
     for (int i = 0; i < regionsOfInterest.size(); i++)
     {
       Rect roi = regionsOfInterest[i];
       
-      // Adjust the ROI to be inside the detection mask (if it exists)
-      if (detector_mask.mask_loaded)
-        roi = detector_mask.getRoiInsideMask(roi);
-
-      // Draw ROIs on debug mask image
-      if (detector_mask.mask_loaded && config->debugDetector)
-        rectangle(mask_debug_img, roi, Scalar(0,255,255), 3);
-      
       // Sanity check.  If roi width or height is less than minimum possible plate size,
       // then skip it
       if ((roi.width < config->minPlateSizeWidthPx) || 
           (roi.height < config->minPlateSizeHeightPx))
         continue;
       
-      Mat cropped = frame_gray(roi);
-
-      int w = cropped.size().width;
-      int h = cropped.size().height;
+      int w = roi.width;
+      int h = roi.height;
       int offset_x = roi.x;
       int offset_y = roi.y;
       float scale_factor = computeScaleFactor(w, h);
 
+      Size scaled_size(w, h);
       if (scale_factor != 1.0)
-        resize(cropped, cropped, Size(w * scale_factor, h * scale_factor));
+        scaled_size = Size(w * scale_factor, h * scale_factor);
+
+      Mat cropped = context->getDetectionInput(frame_gray, roi, scaled_size, equalizesInput());
 
     
       float maxWidth = ((float) w) * (config->maxPlateWidthPercent / 100.0f) * scale_factor;
@@ -204,6 +224,10 @@ namespace alpr
     
   }
 
+  bool Detector::equalizesInput() {
+    return false;
+  }
+
   bool rectHasLargerArea(cv::Rect a, cv::Rect b) { return a.area() < b.area(); };
 
   vector<PlateRegion> Detector::aggregateRegions(vector<Rect> regions)
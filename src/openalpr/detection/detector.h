@@ -29,6 +29,7 @@
 #include "support/timing.h"
 #include "constants.h"
 #include "detectormask.h"
+#include "detectioncontext.h"
 #include "prewarp.h"
 
 namespace alpr
@@ -47,6 +48,10 @@ namespace alpr
       std::vector<PlateRegion> detect(cv::Mat frame);
       std::vector<PlateRegion> detect(cv::Mat frame, std::vector<cv::Rect> regionsOfInterest);
 
+      // Shares the prepared detector inputs with every other detector given the same context
+      std::vector<PlateRegion> detect(cv::Mat frame, std::vector<cv::Rect> regionsOfInterest, DetectionContext* context);
+
+      // The frame may be shared with other detectors, so it must not be modified
       virtual std::vector<cv::Rect> find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size)=0;
       
       void setMask(cv::Mat mask);
@@ -61,6 +66,9 @@ namespace alpr
       std::string get_detector_file();
       
       float computeScaleFactor(int width, int height);
+
+      // True if find_plates expects a histogram equalized frame
+      virtual bool equalizesInput();
       std::vector<PlateRegion> aggregateRegions(std::vector<cv::Rect> regions);
 
 
@@ -59,8 +59,7 @@ namespace alpr
     timespec startTime;
     getTimeMonotonic(&startTime);
 
-    equalizeHist( frame, frame );
-    
+    // The frame has already been equalized (see equalizesInput)
     plate_cascade.detectMultiScale( frame, plates, config->detection_iteration_increase, config->detectionStrictness,
                                       CV_HAAR_DO_CANNY_PRUNING,
                                       //0|CV_HAAR_SCALE_IMAGE,
@@ -78,4 +77,8 @@ namespace alpr
 
   }
 
+  bool DetectorCPU::equalizesInput() {
+    return true;
+  }
+
 }
@@ -38,6 +38,9 @@ namespace alpr
       virtual ~DetectorCPU();
 
       std::vector<cv::Rect> find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size);
+
+  protected:
+      bool equalizesInput();
       
   private:
 
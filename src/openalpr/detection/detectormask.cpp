@@ -19,9 +19,13 @@
 
 #include "detectormask.h"
 #include "prewarp.h"
+#include <support/tinythread.h>
 
 using namespace cv;
 using namespace std;
+
+// Pooled detectors share one PreWarp, and warping the mask updates its transform
+tthread::mutex detectormask_mutex_m;
   
 namespace alpr
 {
@@ -144,6 +148,8 @@ namespace alpr
     if (!resized_mask_loaded || image.size() != resized_mask.size() || 
             last_prewarp_hash != prewarp->toString())
     {
+      tthread::lock_guard<tthread::mutex> guard(detectormask_mutex_m);
+
       resize_mask(image);
       
       last_prewarp_hash = prewarp->toString();
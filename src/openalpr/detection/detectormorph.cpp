@@ -52,7 +52,11 @@ namespace alpr {
 
     Mat frame_gray_cp(frame_gray.size(), frame_gray.type());
     frame_gray.copyTo(frame_gray_cp);
-    blur(frame_gray, frame_gray, Size(5, 5));
+
+    // The frame is shared with other detectors, so blur a copy of it
+    Mat frame_blurred;
+    blur(frame_gray, frame_blurred, Size(5, 5));
+    frame_gray = frame_blurred;
 
     vector<Rect> plates;
     
@@ -112,11 +112,10 @@ namespace alpr
     // If we have an OpenCL core available, use it.  Otherwise use CPU
     if (ocl_detector_mutex_m.try_lock())
     {
+      // The frame has already been equalized (see equalizesInput)
       UMat openclFrame;
       orig_frame.copyTo(openclFrame);
 
-      equalizeHist( openclFrame, openclFrame );
-
       plate_cascade.detectMultiScale( openclFrame, plates, config->detection_iteration_increase, config->detectionStrictness,
                                       CV_HAAR_DO_CANNY_PRUNING,
                                       min_plate_size, max_plate_size );
@@ -125,8 +124,6 @@ namespace alpr
     }
     else
     {
-      equalizeHist( orig_frame, orig_frame );
-
       plate_cascade.detectMultiScale( orig_frame, plates, config->detection_iteration_increase, config->detectionStrictness,
                                       CV_HAAR_DO_CANNY_PRUNING,
                                       min_plate_size, max_plate_size );
@@ -145,6 +142,10 @@ namespace alpr
 
   }
 
+  bool DetectorOCL::equalizesInput() {
+    return true;
+  }
+
 }
 
 #endif
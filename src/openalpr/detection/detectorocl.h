@@ -42,6 +42,9 @@ namespace alpr
 
     std::vector<cv::Rect> find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size);
 
+  protected:
+    bool equalizesInput();
+
   private:
 
     cv::CascadeClassifier plate_cascade;
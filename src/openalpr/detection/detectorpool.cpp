@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "detectorpool.h"
+#include "detectorfactory.h"
+
+namespace alpr
+{
+
+  DetectorPool::DetectorPool(Config* config, PreWarp* prewarp, unsigned int size)
+  {
+    if (size < 1)
+      size = 1;
+
+    for (unsigned int i = 0; i < size; i++)
+    {
+      Detector* detector = createDetector(config, prewarp);
+      instances.push_back(detector);
+      available.push_back(detector);
+    }
+  }
+
+  DetectorPool::~DetectorPool()
+  {
+    for (unsigned int i = 0; i < instances.size(); i++)
+      delete instances[i];
+  }
+
+  Detector* DetectorPool::acquire()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    while (available.size() == 0)
+      instanceReleased.wait(mMutex);
+
+    Detector* detector = available.back();
+    available.pop_back();
+    return detector;
+  }
+
+  void DetectorPool::release(Detector* detector)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    available.push_back(detector);
+    instanceReleased.notify_one();
+  }
+
+  Detector* DetectorPool::primary()
+  {
+    return instances[0];
+  }
+
+  void DetectorPool::setMask(cv::Mat mask)
+  {
+    for (unsigned int i = 0; i < instances.size(); i++)
+      instances[i]->setMask(mask);
+  }
+
+  unsigned int DetectorPool::size()
+  {
+    return instances.size();
+  }
+
+  DetectorGuard::DetectorGuard(DetectorPool* pool)
+  {
+    this->pool = pool;
+    this->detector = pool->acquire();
+  }
+
+  DetectorGuard::~DetectorGuard()
+  {
+    pool->release(detector);
+  }
+
+  Detector* DetectorGuard::get()
+  {
+    return detector;
+  }
+
+}
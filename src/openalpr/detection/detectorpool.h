@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_DETECTORPOOL_H
+#define	OPENALPR_DETECTORPOOL_H
+
+#include <vector>
+
+#include "config.h"
+#include "prewarp.h"
+#include "detector.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Hands out plate detectors to threads that are detecting plates in different images.
+  // The cascade and the detection mask are not safe to share, so an instance is only
+  // used by one thread at a time.
+  class DetectorPool
+  {
+    public:
+      DetectorPool(Config* config, PreWarp* prewarp, unsigned int size);
+      virtual ~DetectorPool();
+
+      // Blocks until an instance is free
+      Detector* acquire();
+      void release(Detector* detector);
+
+      // The first instance created.  Useful for read-only queries (e.g., isLoaded)
+      Detector* primary();
+
+      void setMask(cv::Mat mask);
+
+      unsigned int size();
+
+    private:
+      std::vector<Detector*> instances;
+      std::vector<Detector*> available;
+
+      tthread::mutex mMutex;
+      tthread::condition_variable instanceReleased;
+  };
+
+  // Borrows a detector for the life of the guard, so it goes back to the pool even if detection throws
+  class DetectorGuard
+  {
+    public:
+      DetectorGuard(DetectorPool* pool);
+      virtual ~DetectorGuard();
+
+      Detector* get();
+
+    private:
+      DetectorPool* pool;
+      Detector* detector;
+
+      DetectorGuard(const DetectorGuard&);
+      DetectorGuard& operator=(const DetectorGuard&);
+  };
+
+}
+
+#endif	/* OPENALPR_DETECTORPOOL_H */
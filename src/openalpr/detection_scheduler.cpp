@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "detection_scheduler.h"
+
+#include "utility.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  // Neighbouring tiles overlap by this fraction of a tile, so that a plate on the edge of one is inside another
+  const float TILE_OVERLAP = 0.2;
+
+  // How far around a recent plate to search, as a multiple of the plate's size
+  const float HIT_SEARCH_WIDTH_MULTIPLE = 3.0;
+  const float HIT_SEARCH_HEIGHT_MULTIPLE = 4.0;
+
+  DetectionScheduler::DetectionScheduler(Config* config)
+  {
+    this->columns = max(1, config->detectionScheduleColumns);
+    this->rows = max(1, config->detectionScheduleRows);
+    this->full_scan_interval = max(1, config->detectionScheduleFullScanInterval);
+    this->hit_timeout_ms = config->detectionScheduleHitTimeoutMs;
+
+    this->frames_scheduled = 0;
+    this->next_tile = 0;
+  }
+
+  DetectionScheduler::~DetectionScheduler()
+  {
+  }
+
+  std::vector<cv::Rect> DetectionScheduler::nextRegions(int64_t frame_time, int img_width, int img_height)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    vector<Rect> regions;
+
+    // The first frame is always a full scan
+    bool full_scan = (frames_scheduled % full_scan_interval) == 0;
+    frames_scheduled++;
+
+    if (full_scan)
+    {
+      regions.push_back(Rect(0, 0, img_width, img_height));
+      return regions;
+    }
+
+    regions.push_back(getTile(next_tile, img_width, img_height));
+    next_tile = (next_tile + 1) % (columns * rows);
+
+    vector<Hit> recent_hits;
+    for (unsigned int i = 0; i < hits.size(); i++)
+    {
+      if (hits[i].time < frame_time - hit_timeout_ms)
+        continue;
+
+      recent_hits.push_back(hits[i]);
+
+      Rect hit = hits[i].rect;
+      int search_width = hit.width * HIT_SEARCH_WIDTH_MULTIPLE;
+      int search_height = hit.height * HIT_SEARCH_HEIGHT_MULTIPLE;
+      Rect region = expandRect(hit, search_width - hit.width, search_height - hit.height, img_width, img_height);
+
+      if (region.area() > 0)
+        regions.push_back(region);
+    }
+    hits = recent_hits;
+
+    return mergeOverlappingRects(regions);
+  }
+
+  void DetectionScheduler::addResults(AlprResults results, int64_t frame_time)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    for (unsigned int i = 0; i < results.plates.size(); i++)
+    {
+      vector<Point> points;
+      for (int p_idx = 0; p_idx < 4; p_idx++)
+        points.push_back(Point(results.plates[i].plate_points[p_idx].x, results.plates[i].plate_points[p_idx].y));
+
+      Hit hit;
+      hit.rect = boundingRect(points);
+      hit.time = frame_time;
+      hits.push_back(hit);
+    }
+  }
+
+  // The tile's area of the frame, including its overlap with the neighbouring tiles
+  cv::Rect DetectionScheduler::getTile(int tile, int img_width, int img_height)
+  {
+    int tile_width = img_width / columns;
+    int tile_height = img_height / rows;
+
+    int column = tile % columns;
+    int row = tile / columns;
+
+    Rect region(column * tile_width, row * tile_height, tile_width, tile_height);
+
+    // The last column and row take up whatever the division left over
+    if (column == columns - 1)
+      region.width = img_width - region.x;
+    if (row == rows - 1)
+      region.height = img_height - region.y;
+
+    return expandRect(region, tile_width * TILE_OVERLAP, tile_height * TILE_OVERLAP, img_width, img_height);
+  }
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_DETECTIONSCHEDULER_H
+#define OPENALPR_DETECTIONSCHEDULER_H
+
+#include <vector>
+
+#include "alpr.h"
+#include "config.h"
+
+#include "opencv2/core/core.hpp"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Decides which parts of each frame of a fixed camera to search for plates, so that
+  // detection doesn't have to scan every frame in full.  A plate stays in view for many
+  // frames, so each frame searches one tile of a grid (moving to the next tile every
+  // frame), along with the areas around the plates found recently.  Every Nth frame is
+  // searched in full.  Configured with the detection_schedule settings.
+  // Safe to use from several threads at once.
+  class DetectionScheduler
+  {
+    public:
+      DetectionScheduler(Config* config);
+      virtual ~DetectionScheduler();
+
+      // The regions to search in the next frame, captured at frame_time.  Overlapping regions are merged
+      std::vector<cv::Rect> nextRegions(int64_t frame_time, int img_width, int img_height);
+
+      // Records the plates found in a frame captured at frame_time.  The areas around
+      // them are searched in every frame until the hit timeout passes
+      void addResults(AlprResults results, int64_t frame_time);
+
+    private:
+
+      struct Hit
+      {
+        cv::Rect rect;
+        int64_t time;
+      };
+
+      int columns;
+      int rows;
+      int full_scan_interval;
+      int hit_timeout_ms;
+
+      int frames_scheduled;
+      int next_tile;
+      std::vector<Hit> hits;
+
+      tthread::mutex mMutex;
+
+      cv::Rect getTile(int tile, int img_width, int img_height);
+  };
+
+}
+
+#endif // OPENALPR_DETECTIONSCHEDULER_H
@@ -107,11 +107,13 @@ namespace alpr
     {
       pipelineData->disqualified = true;
       pipelineData->disqualify_reason = "platecorners did not find a left/right edge";
+      pipelineData->disqualify_stage = "plate_corners";
     }
     else if (bestTop.p1.x == 0 && bestTop.p1.y == 0 && bestTop.p2.x == 0 && bestTop.p2.y == 0)
     {
       pipelineData->disqualified = true;
       pipelineData->disqualify_reason = "platecorners did not find a top/bottom edge";
+      pipelineData->disqualify_stage = "plate_corners";
     }
 
 
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "json_writer.h"
+
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+namespace alpr
+{
+
+  JsonWriter::JsonWriter()
+  {
+  }
+
+  JsonWriter::~JsonWriter()
+  {
+  }
+
+  void JsonWriter::clear()
+  {
+    buffer.clear();
+  }
+
+  const std::string& JsonWriter::str() const
+  {
+    return buffer;
+  }
+
+  void JsonWriter::beginObject()
+  {
+    appendSeparator();
+    buffer += '{';
+  }
+
+  void JsonWriter::beginArray()
+  {
+    appendSeparator();
+    buffer += '[';
+  }
+
+  void JsonWriter::beginObject(const std::string& name)
+  {
+    appendName(name);
+    buffer += '{';
+  }
+
+  void JsonWriter::beginArray(const std::string& name)
+  {
+    appendName(name);
+    buffer += '[';
+  }
+
+  void JsonWriter::endObject()
+  {
+    buffer += '}';
+  }
+
+  void JsonWriter::endArray()
+  {
+    buffer += ']';
+  }
+
+  void JsonWriter::addField(const std::string& name, const std::string& value)
+  {
+    appendName(name);
+    appendString(value);
+  }
+
+  void JsonWriter::addField(const std::string& name, int value)
+  {
+    appendName(name);
+
+    char number[16];
+    sprintf(number, "%d", value);
+    buffer += number;
+  }
+
+  void JsonWriter::addField(const std::string& name, int64_t value)
+  {
+    appendName(name);
+
+    char number[24];
+    sprintf(number, "%lld", (long long) value);
+    buffer += number;
+  }
+
+  void JsonWriter::addField(const std::string& name, double value)
+  {
+    appendName(name);
+    appendNumber(value);
+  }
+
+  void JsonWriter::addValue(const std::string& value)
+  {
+    appendSeparator();
+    appendString(value);
+  }
+
+  void JsonWriter::addValue(double value)
+  {
+    appendSeparator();
+    appendNumber(value);
+  }
+
+  void JsonWriter::addResultsFields(const AlprResults& results)
+  {
+    addField("version", 2);
+    addField("data_type", "alpr_results");
+
+    addField("epoch_time", results.epoch_time);
+    addField("img_width", results.img_width);
+    addField("img_height", results.img_height);
+    addField("processing_time_ms", results.total_processing_time_ms);
+
+    // Only present for video frames
+    if (results.frame_number >= 0)
+      addField("frame_number", results.frame_number);
+
+    beginArray("regions_of_interest");
+    for (unsigned int i = 0; i < results.regionsOfInterest.size(); i++)
+    {
+      beginObject();
+      addField("x", results.regionsOfInterest[i].x);
+      addField("y", results.regionsOfInterest[i].y);
+      addField("width", results.regionsOfInterest[i].width);
+      addField("height", results.regionsOfInterest[i].height);
+      endObject();
+    }
+    endArray();
+
+    beginArray("results");
+    for (unsigned int i = 0; i < results.plates.size(); i++)
+    {
+      beginObject();
+      addPlateResultFields(results.plates[i]);
+      endObject();
+    }
+    endArray();
+
+    // Only present when report_stage_times is enabled
+    if (results.stage_times.size() > 0)
+    {
+      beginObject("stage_times_ms");
+      for (unsigned int i = 0; i < results.stage_times.size(); i++)
+        addField(results.stage_times[i].stage, results.stage_times[i].time_ms);
+      endObject();
+    }
+  }
+
+  void JsonWriter::addPlateResultFields(const AlprPlateResult& result)
+  {
+    addField("plate", result.bestPlate.characters);
+    addField("confidence", result.bestPlate.overall_confidence);
+    addField("matches_template", result.bestPlate.matches_template);
+
+    addField("plate_index", result.plate_index);
+
+    addField("region", result.region);
+    addField("region_confidence", result.regionConfidence);
+
+    addField("processing_time_ms", result.processing_time_ms);
+    addField("requested_topn", result.requested_topn);
+
+    beginArray("coordinates");
+    for (int i = 0; i < 4; i++)
+    {
+      beginObject();
+      addField("x", result.plate_points[i].x);
+      addField("y", result.plate_points[i].y);
+      endObject();
+    }
+    endArray();
+
+    beginArray("candidates");
+    for (unsigned int i = 0; i < result.topNPlates.size(); i++)
+    {
+      beginObject();
+      addField("plate", result.topNPlates[i].characters);
+      addField("confidence", result.topNPlates[i].overall_confidence);
+      addField("matches_template", result.topNPlates[i].matches_template);
+      endObject();
+    }
+    endArray();
+  }
+
+  // Values follow the opening bracket or key directly, and anything else after a comma
+  void JsonWriter::appendSeparator()
+  {
+    if (buffer.size() == 0)
+      return;
+
+    char last = buffer[buffer.size() - 1];
+    if (last != '{' && last != '[' && last != ':')
+      buffer += ',';
+  }
+
+  void JsonWriter::appendName(const std::string& name)
+  {
+    appendSeparator();
+    appendString(name);
+    buffer += ':';
+  }
+
+  void JsonWriter::appendString(const std::string& value)
+  {
+    buffer += '"';
+
+    for (unsigned int i = 0; i < value.size(); i++)
+    {
+      unsigned char c = value[i];
+      if (c > 31 && c != '"' && c != '\\')
+      {
+        buffer += c;
+        continue;
+      }
+
+      buffer += '\\';
+      switch (c)
+      {
+        case '\\': buffer += '\\'; break;
+        case '"': buffer += '"'; break;
+        case '\b': buffer += 'b'; break;
+        case '\f': buffer += 'f'; break;
+        case '\n': buffer += 'n'; break;
+        case '\r': buffer += 'r'; break;
+        case '\t': buffer += 't'; break;
+        default:
+          char escaped[8];
+          sprintf(escaped, "u%04x", c);
+          buffer += escaped;
+          break;
+      }
+    }
+
+    buffer += '"';
+  }
+
+  // Same rules as cJSON's print_number
+  void JsonWriter::appendNumber(double value)
+  {
+    char number[64];
+
+    if (value <= INT_MAX && value >= INT_MIN && fabs(((double) (int) value) - value) <= DBL_EPSILON)
+      sprintf(number, "%d", (int) value);
+    else if (fabs(floor(value) - value) <= DBL_EPSILON && fabs(value) < 1.0e60)
+      sprintf(number, "%.0f", value);
+    else if (fabs(value) < 1.0e-6 || fabs(value) > 1.0e9)
+      sprintf(number, "%e", value);
+    else
+      sprintf(number, "%f", value);
+
+    // cJSON switches to the C locale to print numbers.  Fix up the decimal point instead, since
+    // changing the locale isn't thread safe
+    for (char* c = number; *c != '\0'; c++)
+    {
+      if (*c == ',')
+        *c = '.';
+    }
+
+    buffer += number;
+  }
+
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_JSONWRITER_H
+#define OPENALPR_JSONWRITER_H
+
+#include <string>
+#include <stdint.h>
+
+#include "alpr.h"
+
+namespace alpr
+{
+
+  // Writes JSON straight into a string, without building a cJSON tree first.
+  //
+  // Objects are left open until endObject(), so callers can add their own fields before or after
+  // the result fields:
+  //
+  //   writer.clear();
+  //   writer.beginObject();
+  //   writer.addResultsFields(results);
+  //   writer.addField("uuid", uuid);
+  //   writer.endObject();
+  //
+  // clear() keeps the buffer's memory, so a writer that is reused doesn't allocate once the
+  // buffer has grown to fit.  Numbers and strings are formatted the same way cJSON prints them.
+  class JsonWriter
+  {
+    public:
+      JsonWriter();
+      virtual ~JsonWriter();
+
+      // Empties the buffer for a new document
+      void clear();
+
+      // The JSON written since the last clear()
+      const std::string& str() const;
+
+      // An object or array that is an array element, or the top level document
+      void beginObject();
+      void beginArray();
+
+      // An object or array that is a field of the enclosing object
+      void beginObject(const std::string& name);
+      void beginArray(const std::string& name);
+
+      void endObject();
+      void endArray();
+
+      void addField(const std::string& name, const std::string& value);
+      void addField(const std::string& name, int value);
+      void addField(const std::string& name, int64_t value);
+      void addField(const std::string& name, double value);
+
+      // Array elements
+      void addValue(const std::string& value);
+      void addValue(double value);
+
+      // The fields of Alpr::toJson(), written into the open object
+      void addResultsFields(const AlprResults& results);
+      void addPlateResultFields(const AlprPlateResult& result);
+
+    private:
+
+      std::string buffer;
+
+      void appendSeparator();
+      void appendName(const std::string& name);
+      void appendString(const std::string& value);
+      void appendNumber(double value);
+  };
+
+}
+
+#endif // OPENALPR_JSONWRITER_H
@@ -22,6 +22,7 @@
 #include "licenseplatecandidate.h"
 #include "edges/edgefinder.h"
 #include "transformation.h"
+#include "plate_prefilter.h"
 
 using namespace std;
 using namespace cv;
@@ -49,8 +50,14 @@ namespace alpr
 
     Rect expandedRegion = this->pipeline_data->regionOfInterest;
 
-    pipeline_data->crop_gray = Mat(this->pipeline_data->grayImg, expandedRegion);
-    resize(pipeline_data->crop_gray, pipeline_data->crop_gray, Size(config->templateWidthPx, config->templateHeightPx));
+    Size templateSize(config->templateWidthPx, config->templateHeightPx);
+    pipeline_data->crop_gray = pipeline_data->getImage(templateSize, pipeline_data->grayImg.type());
+    resize(Mat(this->pipeline_data->grayImg, expandedRegion), pipeline_data->crop_gray, templateSize);
+
+    // Drop regions that obviously aren't plates before the thresholds and contours are computed
+    PlatePrefilter prefilter(pipeline_data);
+    if (!prefilter.filter())
+      return;
 
 
     CharacterAnalysis textAnalysis(pipeline_data);
@@ -58,10 +65,15 @@ namespace alpr
     if (pipeline_data->disqualified)
       return;
 
+    timespec edgesStartTime;
+    getTimeMonotonic(&edgesStartTime);
+
     EdgeFinder edgeFinder(pipeline_data);
 
     pipeline_data->plate_corners = edgeFinder.findEdgeCorners();
 
+    pipeline_data->addStageTime(STAGE_EDGES, edgesStartTime);
+
     if (pipeline_data->disqualified)
       return;
 
@@ -78,7 +90,7 @@ namespace alpr
 
     // Crop the plate corners from the original color image (after un-applying prewarp)
     vector<Point2f> projectedPoints = pipeline_data->prewarp->projectPoints(pipeline_data->plate_corners, true);
-    pipeline_data->color_deskewed = Mat::zeros(cropSize, pipeline_data->colorImg.type());
+    pipeline_data->color_deskewed = pipeline_data->getZeroImage(cropSize, pipeline_data->colorImg.type());
     std::vector<cv::Point2f> deskewed_points;
     deskewed_points.push_back(cv::Point2f(0,0));
     deskewed_points.push_back(cv::Point2f(pipeline_data->color_deskewed.cols,0));
@@ -87,6 +99,8 @@ namespace alpr
     cv::Mat color_transmtx = cv::getPerspectiveTransform(projectedPoints, deskewed_points);
     cv::warpPerspective(pipeline_data->colorImg, pipeline_data->color_deskewed, color_transmtx, pipeline_data->color_deskewed.size());
 
+    // The deskewed crop is a different size than the template sized one, so it gets its own image
+    pipeline_data->crop_gray = pipeline_data->getImage(cropSize, CV_8U);
     if (pipeline_data->color_deskewed.channels() > 2)
     {
       // Make a grayscale copy as well for faster processing downstream
@@ -127,12 +141,9 @@ namespace alpr
 
 
 
+    double deskewTime = pipeline_data->addStageTime(STAGE_DESKEW, startTime);
     if (config->debugTiming)
-    {
-      timespec endTime;
-      getTimeMonotonic(&endTime);
-      cout << "deskew Time: " << diffclock(startTime, endTime) << "ms." << endl;
-    }
+      cout << "deskew Time: " << deskewTime << "ms." << endl;
 
 
 
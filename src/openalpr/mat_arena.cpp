@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mat_arena.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  MatArena::MatArena(unsigned int max_buffers)
+  {
+    this->max_buffers = max_buffers;
+    this->allocations = 0;
+    this->reuses = 0;
+  }
+
+  MatArena::~MatArena()
+  {
+  }
+
+  cv::Mat MatArena::get(cv::Size size, int type)
+  {
+    int replaceable = -1;
+
+    for (unsigned int i = 0; i < buffers.size(); i++)
+    {
+      if (!isFree(buffers[i]))
+        continue;
+
+      if (buffers[i].size() == size && buffers[i].type() == type)
+      {
+        reuses++;
+        return buffers[i];
+      }
+
+      if (replaceable < 0)
+        replaceable = i;
+    }
+
+    allocations++;
+    Mat buffer(size, type);
+
+    // When the arena is full, drop an idle image of some other size to make room
+    if (buffers.size() < max_buffers)
+      buffers.push_back(buffer);
+    else if (replaceable >= 0)
+      buffers[replaceable] = buffer;
+
+    return buffer;
+  }
+
+  cv::Mat MatArena::zeros(cv::Size size, int type)
+  {
+    Mat buffer = get(size, type);
+    buffer.setTo(Scalar::all(0));
+    return buffer;
+  }
+
+  int64_t MatArena::getAllocations()
+  {
+    return allocations;
+  }
+
+  int64_t MatArena::getReuses()
+  {
+    return reuses;
+  }
+
+  void MatArena::resetCounts()
+  {
+    allocations = 0;
+    reuses = 0;
+  }
+
+  // True when nobody but the arena refers to the buffer.  The last plate's results may still be
+  // releasing their references on another thread, so the count is read atomically (by adding 0)
+  bool MatArena::isFree(const cv::Mat& buffer)
+  {
+#if OPENCV_MAJOR_VERSION == 2
+    return buffer.refcount != NULL && CV_XADD(buffer.refcount, 0) == 1;
+#else
+    return buffer.u != NULL && CV_XADD(&buffer.u->refcount, 0) == 1;
+#endif
+  }
+
+  MatArenaPool::MatArenaPool(unsigned int max_buffers)
+  {
+    this->max_buffers = max_buffers;
+  }
+
+  MatArenaPool::~MatArenaPool()
+  {
+    for (unsigned int i = 0; i < arenas.size(); i++)
+      delete arenas[i];
+  }
+
+  MatArena* MatArenaPool::acquire()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    if (available.size() > 0)
+    {
+      MatArena* arena = available.back();
+      available.pop_back();
+      return arena;
+    }
+
+    MatArena* arena = new MatArena(max_buffers);
+    arenas.push_back(arena);
+    return arena;
+  }
+
+  void MatArenaPool::release(MatArena* arena)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    available.push_back(arena);
+  }
+
+}
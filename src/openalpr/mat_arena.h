@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_MATARENA_H
+#define OPENALPR_MATARENA_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Keeps the fixed size images a plate analysis needs (template sized crops, thresholds,
+  // masks, etc.) so that the next plate can reuse them instead of allocating its own.
+  //
+  // The arena holds a reference to every buffer it hands out.  A buffer becomes free again
+  // once the arena's reference is the only one left, so callers simply drop their Mat
+  // when they are done with it.  Not thread safe.  Each plate borrows one from a MatArenaPool.
+  class MatArena
+  {
+    public:
+      // Keeps at most max_buffers images.  Past that, requests are served by a plain allocation
+      MatArena(unsigned int max_buffers);
+      virtual ~MatArena();
+
+      // An image of the given size and type.  The contents are whatever the last user left
+      cv::Mat get(cv::Size size, int type);
+
+      // Same as get(), cleared to zero
+      cv::Mat zeros(cv::Size size, int type);
+
+      // Number of requests that needed a new image / were served by a recycled one
+      int64_t getAllocations();
+      int64_t getReuses();
+
+      // Resets the allocation and reuse counts to zero
+      void resetCounts();
+
+    private:
+      unsigned int max_buffers;
+
+      std::vector<cv::Mat> buffers;
+
+      int64_t allocations;
+      int64_t reuses;
+
+      static bool isFree(const cv::Mat& buffer);
+  };
+
+  // Hands out arenas to plate analysis workers.  There are never more arenas than plates
+  // analyzed at once, so each worker thread effectively keeps its own between plates and frames.
+  class MatArenaPool
+  {
+    public:
+      MatArenaPool(unsigned int max_buffers);
+      virtual ~MatArenaPool();
+
+      // Never blocks
+      MatArena* acquire();
+      void release(MatArena* arena);
+
+    private:
+      unsigned int max_buffers;
+
+      std::vector<MatArena*> arenas;
+      std::vector<MatArena*> available;
+
+      tthread::mutex mMutex;
+  };
+
+}
+
+#endif // OPENALPR_MATARENA_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <map>
+
+#include "modelbundle.h"
+
+using namespace std;
+
+tthread::mutex modelbundle_mutex_m;
+
+namespace alpr
+{
+
+  // Guarded by modelbundle_mutex_m
+  static map<string, ModelBundle*> loaded_bundles;
+
+  ModelBundle::ModelBundle(Config* config, string key)
+  {
+    this->key = key;
+    this->references = 0;
+
+    this->config = new Config(*config);
+
+    ocrPool = new OcrPool(this->config, 1);
+
+    #ifndef SKIP_STATE_DETECTION
+    stateDetector = new StateDetector(this->config->country, this->config->config_file_path, this->config->runtimeBaseDir);
+    #else
+    stateDetector = NULL;
+    #endif
+  }
+
+  ModelBundle::~ModelBundle()
+  {
+    delete ocrPool;
+    delete stateDetector;
+    delete config;
+  }
+
+  ModelBundle* ModelBundle::acquire(Config* config)
+  {
+    string key = config->runtimeBaseDir + "|" + config->config_file_path + "|" + config->country;
+
+    tthread::lock_guard<tthread::mutex> guard(modelbundle_mutex_m);
+
+    ModelBundle* bundle;
+    map<string, ModelBundle*>::iterator it = loaded_bundles.find(key);
+    if (it == loaded_bundles.end())
+    {
+      bundle = new ModelBundle(config, key);
+      loaded_bundles[key] = bundle;
+    }
+    else
+    {
+      bundle = it->second;
+    }
+
+    bundle->references++;
+    return bundle;
+  }
+
+  void ModelBundle::release(ModelBundle* bundle)
+  {
+    tthread::lock_guard<tthread::mutex> guard(modelbundle_mutex_m);
+
+    bundle->references--;
+    if (bundle->references == 0)
+    {
+      loaded_bundles.erase(bundle->key);
+      delete bundle;
+    }
+  }
+
+}
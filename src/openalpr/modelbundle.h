@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_MODELBUNDLE_H
+#define	OPENALPR_MODELBUNDLE_H
+
+#include <string>
+
+#include "config.h"
+#include "ocr/ocrpool.h"
+#include "../statedetection/state_detector.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // The loaded models for one country.  Every Alpr instance in the process that loads the same
+  // country from the same config file and runtime data shares a single, reference-counted bundle.
+  class ModelBundle
+  {
+    public:
+
+      // Returns the bundle for the config's current country, loading it if required.
+      // Each acquire must be balanced by a release.
+      static ModelBundle* acquire(Config* config);
+      static void release(ModelBundle* bundle);
+
+      // Snapshot of the config the models were loaded with.  Never modified
+      Config* config;
+
+      OcrPool* ocrPool;
+
+      // NULL when state detection is compiled out.  Only one thread may use it at a time
+      StateDetector* stateDetector;
+      tthread::mutex stateDetectorMutex;
+
+    private:
+      ModelBundle(Config* config, std::string key);
+      virtual ~ModelBundle();
+
+      std::string key;
+      int references;
+  };
+
+}
+
+#endif	/* OPENALPR_MODELBUNDLE_H */
@@ -4,9 +4,28 @@ using namespace cv;
 
 namespace alpr
 {
-  
+
+// Motion areas smaller than this (in downscaled pixels) are treated as noise
+const int MIN_MOTION_AREA = 64;
+
+// Each motion area is grown by this fraction of its size, so that a plate at the edge
+// of a moving vehicle is fully inside the region that gets analyzed
+const float MOTION_REGION_PADDING = 0.25;
+
 MotionDetector::MotionDetector()
 {
+	init(0);
+}
+
+MotionDetector::MotionDetector(int max_width)
+{
+	init(max_width);
+}
+
+void MotionDetector::init(int max_width)
+{
+	this->maxWidth = max_width;
+
 	#if OPENCV_MAJOR_VERSION == 2
 	pMOG2 = new BackgroundSubtractorMOG2();
 	#else
@@ -84,4 +103,51 @@ cv::Rect MotionDetector::MotionDetect(cv::Mat* frame)
 	return expandRect(largest_rect, 0, 0, frame->cols, frame->rows);
 }
 
-}
\ No newline at end of file
+std::vector<cv::Rect> MotionDetector::MotionDetectRegions(const cv::Mat& frame)
+{
+	std::vector<cv::Rect> regions;
+
+	// Background subtraction is by far the most expensive step, and it doesn't need full resolution
+	float scale = 1.0;
+	if (maxWidth > 0 && frame.cols > maxWidth)
+	{
+		scale = ((float) maxWidth) / ((float) frame.cols);
+		resize(frame, scaledFrame, cv::Size(maxWidth, round(frame.rows * scale)), 0, 0, cv::INTER_AREA);
+	}
+	else
+	{
+		scaledFrame = frame;
+	}
+
+#if OPENCV_MAJOR_VERSION == 2
+	pMOG2->operator()(scaledFrame, fgMaskMOG2, -1);
+#else
+	// OpenCV 3
+	pMOG2->apply(scaledFrame, fgMaskMOG2);
+#endif
+
+	// Drop shadows (marked as gray by MOG2) and remove noise
+	cv::threshold(fgMaskMOG2, fgMaskMOG2, 200, 255, cv::THRESH_BINARY);
+	cv::erode(fgMaskMOG2, fgMaskMOG2, getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3)));
+
+	std::vector<std::vector<cv::Point> > contours;
+	std::vector<cv::Vec4i> hierarchy;
+	findContours(fgMaskMOG2, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+
+	for (unsigned int i = 0; i < contours.size(); i++)
+	{
+		cv::Rect blob = boundingRect(contours[i]);
+		if (blob.area() < MIN_MOTION_AREA)
+			continue;
+
+		cv::Rect region(blob.x / scale, blob.y / scale, blob.width / scale, blob.height / scale);
+		region = expandRect(region, region.width * MOTION_REGION_PADDING, region.height * MOTION_REGION_PADDING,
+		                    frame.cols, frame.rows);
+		regions.push_back(region);
+	}
+
+	// Merge overlapping regions so that no part of the frame is analyzed twice
+	return mergeOverlappingRects(regions);
+}
+
+}
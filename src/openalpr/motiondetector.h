@@ -11,12 +11,23 @@ namespace alpr
   {
       private: cv::Ptr<cv::BackgroundSubtractor> pMOG2; //MOG2 Background subtractor
       private: cv::Mat fgMaskMOG2;
+      private: cv::Mat scaledFrame;
+      private: int maxWidth;
       public:
           MotionDetector();
+          // Frames wider than max_width are downscaled before motion detection.  0 disables scaling
+          MotionDetector(int max_width);
           virtual ~MotionDetector();
 
           void ResetMotionDetection(cv::Mat* frame);
           cv::Rect MotionDetect(cv::Mat* frame);
+
+          // Returns one rectangle (in frame coordinates) per separate area of motion, or an
+          // empty list if nothing moved.  Unlike MotionDetect, the frame is left untouched
+          std::vector<cv::Rect> MotionDetectRegions(const cv::Mat& frame);
+
+      private:
+          void init(int max_width);
   };
 }
 
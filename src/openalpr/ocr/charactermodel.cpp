@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "charactermodel.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "opencv2/imgproc/imgproc.hpp"
+#include "opencv2/objdetect/objdetect.hpp"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  const char CHARACTER_MODEL_MAGIC[] = "OALPRCHM";
+  const int CHARACTER_MODEL_MAGIC_LENGTH = 8;
+  const int CHARACTER_MODEL_VERSION = 1;
+
+  // Anything larger means the file is corrupt
+  const unsigned int MAX_CHARACTER_MODEL_LABELS = 65536;
+  const unsigned int MAX_CHARACTER_MODEL_SAMPLES = 10000000;
+
+  // Crops are scaled into a cell this size before the HOG features are computed
+  const int CHARACTER_CELL_WIDTH = 16;
+  const int CHARACTER_CELL_HEIGHT = 24;
+
+  // HOG values (after L2-Hys normalization) stay below 0.5, so this fills the byte range
+  const float FEATURE_QUANTIZATION_SCALE = 510;
+
+  static void writeUint32(ofstream& out, unsigned int value)
+  {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++)
+      bytes[i] = (value >> (8 * i)) & 0xFF;
+    out.write((char*) bytes, 4);
+  }
+
+  static unsigned int readUint32(ifstream& in)
+  {
+    unsigned char bytes[4] = { 0, 0, 0, 0 };
+    in.read((char*) bytes, 4);
+
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++)
+      value |= ((unsigned int) bytes[i]) << (8 * i);
+    return value;
+  }
+
+  // Bytes left between the read position and the end of the file
+  static uint64_t remainingBytes(ifstream& in, uint64_t file_size)
+  {
+    streampos position = in.tellg();
+    if (position < 0 || (uint64_t) position > file_size)
+      return 0;
+
+    return file_size - (uint64_t) position;
+  }
+
+  static bool compareMatches(const CharacterMatch& a, const CharacterMatch& b)
+  {
+    return a.confidence > b.confidence;
+  }
+
+  CharacterModel::CharacterModel()
+  {
+    feature_length = 0;
+    max_distance = 0;
+  }
+
+  CharacterModel::~CharacterModel()
+  {
+  }
+
+  bool CharacterModel::load(std::string filename)
+  {
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in.is_open())
+      return false;
+
+    // The counts in the header are checked against the size of the file before anything is
+    // allocated for them, so a truncated or corrupt model can't ask for gigabytes
+    in.seekg(0, ios::end);
+    streampos end_position = in.tellg();
+    in.seekg(0, ios::beg);
+    if (end_position < 0)
+      return false;
+    uint64_t file_size = (uint64_t) end_position;
+
+    char magic[CHARACTER_MODEL_MAGIC_LENGTH];
+    in.read(magic, CHARACTER_MODEL_MAGIC_LENGTH);
+    if (!in || memcmp(magic, CHARACTER_MODEL_MAGIC, CHARACTER_MODEL_MAGIC_LENGTH) != 0)
+      return false;
+
+    if (readUint32(in) != CHARACTER_MODEL_VERSION)
+      return false;
+
+    int file_feature_length = readUint32(in);
+    if (file_feature_length != (int) computeFeatures(Mat()).size())
+      return false;
+
+    float file_max_distance = readUint32(in) / 100.0f;
+
+    // Each label takes at least its length
+    unsigned int label_count = readUint32(in);
+    if (!in || label_count > MAX_CHARACTER_MODEL_LABELS || ((uint64_t) label_count) * 4 > remainingBytes(in, file_size))
+      return false;
+
+    vector<string> file_labels(label_count);
+    for (unsigned int i = 0; in && i < file_labels.size(); i++)
+    {
+      unsigned int length = readUint32(in);
+      if (length > 16)
+        return false;
+
+      char letter[16];
+      in.read(letter, length);
+      file_labels[i] = string(letter, length);
+    }
+
+    // Each sample is its label index and its features
+    unsigned int sample_count = readUint32(in);
+    if (!in || sample_count > MAX_CHARACTER_MODEL_SAMPLES ||
+        ((uint64_t) sample_count) * (4 + file_feature_length) > remainingBytes(in, file_size))
+      return false;
+
+    vector<int> file_sample_labels;
+    vector<unsigned char> file_features(sample_count * file_feature_length);
+    for (unsigned int i = 0; in && i < sample_count; i++)
+    {
+      unsigned int label = readUint32(in);
+      if (label >= file_labels.size())
+        return false;
+
+      file_sample_labels.push_back(label);
+      in.read((char*) &file_features[i * file_feature_length], file_feature_length);
+    }
+
+    if (!in)
+      return false;
+
+    labels = file_labels;
+    sample_labels = file_sample_labels;
+    features = file_features;
+    feature_length = file_feature_length;
+    max_distance = file_max_distance;
+
+    return true;
+  }
+
+  bool CharacterModel::save(std::string filename)
+  {
+    ofstream out(filename.c_str(), ios::out | ios::binary);
+    if (!out.is_open())
+      return false;
+
+    out.write(CHARACTER_MODEL_MAGIC, CHARACTER_MODEL_MAGIC_LENGTH);
+    writeUint32(out, CHARACTER_MODEL_VERSION);
+    writeUint32(out, feature_length);
+    writeUint32(out, (unsigned int) (max_distance * 100));
+
+    writeUint32(out, labels.size());
+    for (unsigned int i = 0; i < labels.size(); i++)
+    {
+      writeUint32(out, labels[i].length());
+      out.write(labels[i].c_str(), labels[i].length());
+    }
+
+    writeUint32(out, sample_labels.size());
+    for (unsigned int i = 0; i < sample_labels.size(); i++)
+    {
+      writeUint32(out, sample_labels[i]);
+      out.write((char*) &features[i * feature_length], feature_length);
+    }
+
+    return out.good();
+  }
+
+  bool CharacterModel::isLoaded()
+  {
+    return sample_labels.size() > 0;
+  }
+
+  int CharacterModel::getSampleCount()
+  {
+    return sample_labels.size();
+  }
+
+  std::vector<std::string> CharacterModel::getLabels()
+  {
+    return labels;
+  }
+
+  std::vector<int> CharacterModel::getLabelCounts()
+  {
+    vector<int> counts(labels.size(), 0);
+    for (unsigned int i = 0; i < sample_labels.size(); i++)
+      counts[sample_labels[i]]++;
+
+    return counts;
+  }
+
+  void CharacterModel::addSample(std::string letter, const cv::Mat& crop)
+  {
+    vector<unsigned char> sample_features = computeFeatures(crop);
+
+    feature_length = sample_features.size();
+    sample_labels.push_back(getLabelIndex(letter));
+    features.insert(features.end(), sample_features.begin(), sample_features.end());
+  }
+
+  float CharacterModel::calibrate(int neighbors)
+  {
+    if (sample_labels.size() < 2)
+      return 0;
+
+    vector<int> nearest_distances;
+    int correct = 0;
+
+    // Classify each sample using every other one
+    for (unsigned int i = 0; i < sample_labels.size(); i++)
+    {
+      vector<pair<int, int> > nearest;
+      findNeighbors(&features[i * feature_length], neighbors, i, &nearest);
+
+      nearest_distances.push_back(nearest[0].first);
+
+      vector<CharacterMatch> matches = vote(nearest);
+      if (matches[0].letter == labels[sample_labels[i]])
+        correct++;
+    }
+
+    // Most genuine characters land within the distance that covers 95% of the training samples
+    sort(nearest_distances.begin(), nearest_distances.end());
+    int typical_distance = nearest_distances[(nearest_distances.size() * 95) / 100];
+    max_distance = 2 * max(typical_distance, 1);
+
+    return ((float) correct) / sample_labels.size();
+  }
+
+  std::vector<CharacterMatch> CharacterModel::classify(const cv::Mat& crop, int neighbors)
+  {
+    if (!isLoaded())
+      return vector<CharacterMatch>();
+
+    vector<unsigned char> crop_features = computeFeatures(crop);
+
+    vector<pair<int, int> > nearest;
+    findNeighbors(&crop_features[0], neighbors, -1, &nearest);
+
+    return vote(nearest);
+  }
+
+  // The background fills most of a character crop's border.  Tiny crops go by the majority of all their pixels
+  static bool hasLightBackground(const cv::Mat& gray)
+  {
+    if (gray.empty())
+      return false;
+
+    int light = 0;
+    int total = 0;
+    if (gray.rows < 3 || gray.cols < 3)
+    {
+      light = countNonZero(gray > 127);
+      total = gray.rows * gray.cols;
+    }
+    else
+    {
+      light = countNonZero(gray.row(0) > 127) + countNonZero(gray.row(gray.rows - 1) > 127) +
+              countNonZero(gray(Rect(0, 1, 1, gray.rows - 2)) > 127) +
+              countNonZero(gray(Rect(gray.cols - 1, 1, 1, gray.rows - 2)) > 127);
+      total = 2 * gray.cols + 2 * (gray.rows - 2);
+    }
+
+    return light * 2 > total;
+  }
+
+  std::vector<unsigned char> CharacterModel::computeFeatures(const cv::Mat& crop)
+  {
+    HOGDescriptor hog(Size(CHARACTER_CELL_WIDTH, CHARACTER_CELL_HEIGHT), Size(8, 8), Size(4, 4), Size(4, 4), 9);
+
+    Mat cell = Mat::zeros(CHARACTER_CELL_HEIGHT, CHARACTER_CELL_WIDTH, CV_8U);
+
+    Mat gray = crop;
+    if (crop.channels() > 2)
+      cvtColor(crop, gray, CV_BGR2GRAY);
+
+    // Plate thresholds are white text on black, but crops saved after Tesseract has run (e.g., by
+    // classifychars) are black on white.  Flip those so training and classification see the same thing
+    if (hasLightBackground(gray))
+    {
+      Mat inverted;
+      bitwise_not(gray, inverted);
+      gray = inverted;
+    }
+
+    // Trim the crop to its text, then center it in the cell
+    Rect text_box;
+    if (!gray.empty())
+    {
+      vector<Point> text_points;
+      Mat text_mask = gray > 127;
+      findNonZero(text_mask, text_points);
+      if (text_points.size() > 0)
+        text_box = boundingRect(text_points);
+    }
+
+    if (text_box.area() > 0)
+    {
+      float scale = min(((float) CHARACTER_CELL_WIDTH) / text_box.width, ((float) CHARACTER_CELL_HEIGHT) / text_box.height);
+      Size scaled_size(max(1, (int) round(text_box.width * scale)), max(1, (int) round(text_box.height * scale)));
+
+      Mat scaled;
+      resize(gray(text_box), scaled, scaled_size, 0, 0, INTER_AREA);
+
+      Rect placement((CHARACTER_CELL_WIDTH - scaled_size.width) / 2, (CHARACTER_CELL_HEIGHT - scaled_size.height) / 2,
+                     scaled_size.width, scaled_size.height);
+      scaled.copyTo(cell(placement));
+    }
+
+    vector<float> descriptors;
+    hog.compute(cell, descriptors);
+
+    vector<unsigned char> quantized(descriptors.size());
+    for (unsigned int i = 0; i < descriptors.size(); i++)
+      quantized[i] = (unsigned char) min(255, (int) (descriptors[i] * FEATURE_QUANTIZATION_SCALE + 0.5f));
+
+    return quantized;
+  }
+
+  int CharacterModel::getLabelIndex(std::string letter)
+  {
+    for (unsigned int i = 0; i < labels.size(); i++)
+    {
+      if (labels[i] == letter)
+        return i;
+    }
+
+    labels.push_back(letter);
+    return labels.size() - 1;
+  }
+
+  // Fills nearest with the (squared distance, sample) of the closest samples, closest first
+  void CharacterModel::findNeighbors(const unsigned char* sample_features, int neighbors, int skip_sample,
+                                     std::vector<std::pair<int, int> >* nearest)
+  {
+    nearest->clear();
+    if (neighbors < 1)
+      neighbors = 1;
+
+    for (unsigned int i = 0; i < sample_labels.size(); i++)
+    {
+      if ((int) i == skip_sample)
+        continue;
+
+      const unsigned char* other = &features[i * feature_length];
+      int distance = 0;
+      for (int f = 0; f < feature_length; f++)
+      {
+        int diff = ((int) sample_features[f]) - ((int) other[f]);
+        distance += diff * diff;
+      }
+
+      if ((int) nearest->size() == neighbors && distance >= nearest->back().first)
+        continue;
+
+      // Keep the list sorted.  It is only ever a handful of entries long
+      vector<pair<int, int> >::iterator position = upper_bound(nearest->begin(), nearest->end(), make_pair(distance, (int) i));
+      nearest->insert(position, make_pair(distance, (int) i));
+      if ((int) nearest->size() > neighbors)
+        nearest->pop_back();
+    }
+  }
+
+  // Each neighbour votes for its letter, weighted by how close it is.  A letter's confidence is its
+  // share of the vote, reduced once even its closest sample is unusually far away
+  std::vector<CharacterMatch> CharacterModel::vote(const std::vector<std::pair<int, int> >& nearest)
+  {
+    map<int, float> label_weights;
+    map<int, int> label_distances;
+    float total_weight = 0;
+
+    for (unsigned int i = 0; i < nearest.size(); i++)
+    {
+      int label = sample_labels[nearest[i].second];
+      float weight = 1.0f / (1.0f + sqrt((float) nearest[i].first));
+
+      label_weights[label] += weight;
+      total_weight += weight;
+
+      // nearest is sorted, so the first distance seen for a label is its closest
+      if (label_distances.find(label) == label_distances.end())
+        label_distances[label] = nearest[i].first;
+    }
+
+    vector<CharacterMatch> matches;
+    for (map<int, float>::iterator it = label_weights.begin(); it != label_weights.end(); it++)
+    {
+      float distance_factor = 1;
+      float distance = label_distances[it->first];
+      if (max_distance > 0 && distance > max_distance / 2)
+        distance_factor = max(0.0f, 2 - 2 * distance / max_distance);
+
+      CharacterMatch match;
+      match.letter = labels[it->first];
+      match.confidence = 100 * (it->second / total_weight) * distance_factor;
+      matches.push_back(match);
+    }
+
+    stable_sort(matches.begin(), matches.end(), compareMatches);
+
+    return matches;
+  }
+
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_CHARACTERMODEL_H
+#define OPENALPR_CHARACTERMODEL_H
+
+#include <string>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+namespace alpr
+{
+
+  struct CharacterMatch
+  {
+    std::string letter;
+    float confidence;
+  };
+
+  // Labeled HOG features of character crops, classified by their nearest neighbours.
+  //
+  // Crops are white text on black, the same as the thresholds they are cut from.  Each one is
+  // trimmed to its text, scaled (keeping its aspect ratio) into a fixed size cell and described by
+  // a HOG vector quantized to a byte per value.
+  //
+  // On disk the model is:
+  //   "OALPRCHM", version, feature length, max distance, label count, labels, sample count, samples
+  // with every number a little-endian uint32 (max distance is in hundredths) and each sample a
+  // uint32 label index followed by its features.
+  class CharacterModel
+  {
+    public:
+      CharacterModel();
+      virtual ~CharacterModel();
+
+      bool load(std::string filename);
+      bool save(std::string filename);
+
+      bool isLoaded();
+      int getSampleCount();
+      std::vector<std::string> getLabels();
+      std::vector<int> getLabelCounts();
+
+      void addSample(std::string letter, const cv::Mat& crop);
+
+      // Sets the distance beyond which a match loses confidence from the distances between
+      // the training samples.  Returns the fraction of samples that their neighbours classify correctly
+      float calibrate(int neighbors);
+
+      // Returns the letters the crop may be, best first, with a 0-100 confidence
+      std::vector<CharacterMatch> classify(const cv::Mat& crop, int neighbors);
+
+      static std::vector<unsigned char> computeFeatures(const cv::Mat& crop);
+
+    private:
+
+      std::vector<std::string> labels;
+
+      // One row of features per sample
+      std::vector<int> sample_labels;
+      std::vector<unsigned char> features;
+      int feature_length;
+
+      // A match this far away (squared) has no confidence left.  Half as far keeps all of it
+      float max_distance;
+
+      int getLabelIndex(std::string letter);
+      void findNeighbors(const unsigned char* sample_features, int neighbors, int skip_sample,
+                         std::vector<std::pair<int, int> >* nearest);
+      std::vector<CharacterMatch> vote(const std::vector<std::pair<int, int> >& nearest);
+  };
+
+}
+
+#endif // OPENALPR_CHARACTERMODEL_H
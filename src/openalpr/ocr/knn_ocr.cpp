@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "knn_ocr.h"
+
+#include "segmentation/charactersegmenter.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  KnnOcr::KnnOcr(Config* config)
+  : OCR(config)
+  {
+    this->postProcessor.setConfidenceThreshold(config->postProcessMinConfidence, config->postProcessConfidenceSkipLevel);
+
+    if (!model.load(config->getCharacterModelFile()))
+      std::cerr << "--(!) Unable to load character model: " << config->getCharacterModelFile() << endl;
+  }
+
+  KnnOcr::~KnnOcr()
+  {
+  }
+
+  std::vector<OcrChar> KnnOcr::recognize_line(int line_idx, PipelineData* pipeline_data) {
+
+    std::vector<OcrChar> recognized_chars;
+
+    for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
+    {
+      for (unsigned int j = 0; j < pipeline_data->charRegions[line_idx].size(); j++)
+      {
+        Rect charRegion = expandRect(pipeline_data->charRegions[line_idx][j], 0, 0, pipeline_data->thresholds[i].cols, pipeline_data->thresholds[i].rows);
+
+        vector<CharacterMatch> matches = model.classify(pipeline_data->thresholds[i](charRegion), config->ocrKnnNeighbors);
+
+        for (unsigned int m = 0; m < matches.size(); m++)
+        {
+          OcrChar c;
+          c.char_index = j;
+          c.confidence = matches[m].confidence;
+          c.letter = matches[m].letter;
+          recognized_chars.push_back(c);
+
+          // Tesseract reports its best choice twice, and the postprocess scoring is tuned for that
+          if (m == 0)
+            recognized_chars.push_back(c);
+
+          if (this->config->debugOcr)
+            printf("charpos%d line%d: threshold %d:  symbol %s, conf: %f\n", j, line_idx, i, matches[m].letter.c_str(), matches[m].confidence);
+        }
+      }
+    }
+
+    return recognized_chars;
+  }
+
+  void KnnOcr::segment(PipelineData* pipeline_data) {
+
+    CharacterSegmenter segmenter(pipeline_data);
+    segmenter.segment();
+  }
+
+}
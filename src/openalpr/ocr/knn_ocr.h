@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_KNNOCR_H
+#define OPENALPR_KNNOCR_H
+
+#include <vector>
+
+#include "config.h"
+#include "pipeline_data.h"
+
+#include "ocr.h"
+#include "charactermodel.h"
+
+namespace alpr
+{
+
+  // Classifies each character crop with a nearest neighbour model (see CharacterModel) rather
+  // than running a full OCR engine.  Meant for plates with a fixed font the model was trained on.
+  class KnnOcr : public OCR
+  {
+
+    public:
+      KnnOcr(Config* config);
+      virtual ~KnnOcr();
+
+    private:
+
+      std::vector<OcrChar> recognize_line(int line_index, PipelineData* pipeline_data);
+      void segment(PipelineData* pipeline_data);
+
+      CharacterModel model;
+
+  };
+
+}
+
+#endif // OPENALPR_KNNOCR_H
@@ -18,16 +18,28 @@
 */
 
 #include "ocr.h"
+#include "ocrcache.h"
+
+using namespace std;
+using namespace cv;
 
 namespace alpr
 {
   
   OCR::OCR(Config* config) : postProcessor(config) {
     this->config = config;
+    this->cache = NULL;
   }
 
 
   OCR::~OCR() {
+    delete cache;
+  }
+
+  void OCR::setConfig(Config* config)
+  {
+    this->config = config;
+    postProcessor.setConfig(config);
   }
 
   
@@ -38,6 +50,10 @@ namespace alpr
     getTimeMonotonic(&startTime);
 
     segment(pipeline_data);
+    pipeline_data->addStageTime(STAGE_SEGMENT, startTime);
+
+    timespec recognizeStartTime;
+    getTimeMonotonic(&recognizeStartTime);
     
     postProcessor.clear();
 
@@ -45,7 +61,11 @@ namespace alpr
     int absolute_charpos = 0;
     for (unsigned int line_idx = 0; line_idx < pipeline_data->textLines.size(); line_idx++)
     {
-      std::vector<OcrChar> chars = recognize_line(line_idx, pipeline_data);
+      std::vector<OcrChar> chars;
+      if (config->ocrCache)
+        chars = recognize_line_cached(line_idx, pipeline_data);
+      else
+        chars = recognize_line(line_idx, pipeline_data);
       
       for (uint32_t i = 0; i < chars.size(); i++)
       {
@@ -57,6 +77,8 @@ namespace alpr
     }
     
 
+    pipeline_data->addStageTime(STAGE_OCR, recognizeStartTime);
+
     if (config->debugTiming)
     {
       timespec endTime;
@@ -64,4 +86,76 @@ namespace alpr
       std::cout << "OCR Time: " << diffclock(startTime, endTime) << "ms." << std::endl;
     }
   }
-}
\ No newline at end of file
+
+  // Only the characters that aren't in the cache are sent to the engine
+  std::vector<OcrChar> OCR::recognize_line_cached(int line_idx, PipelineData* pipeline_data)
+  {
+    if (cache == NULL)
+      cache = new OcrCache(config->ocrCacheSize, config->ocrCacheMaxDistance);
+
+    vector<Rect> charRegions = pipeline_data->charRegions[line_idx];
+
+    vector<vector<uint64_t> > hashes(charRegions.size());
+    vector<vector<OcrChar> > char_results(charRegions.size());
+    vector<int> missing;
+
+    for (unsigned int j = 0; j < charRegions.size(); j++)
+    {
+      for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
+      {
+        Rect charRegion = expandRect(charRegions[j], 0, 0, pipeline_data->thresholds[i].cols, pipeline_data->thresholds[i].rows);
+        hashes[j].push_back(OcrCache::hashCrop(pipeline_data->thresholds[i](charRegion)));
+      }
+
+      if (!cache->lookup(charRegions[j].size(), hashes[j], &char_results[j]))
+        missing.push_back(j);
+    }
+
+    pipeline_data->addCount("ocr_cache_hits", charRegions.size() - missing.size());
+    pipeline_data->addCount("ocr_cache_misses", missing.size());
+
+    if (missing.size() > 0)
+    {
+      // The engine reads the line's boxes from pipeline_data, so hand it just the missing ones
+      vector<Rect> missingRegions;
+      for (unsigned int m = 0; m < missing.size(); m++)
+        missingRegions.push_back(charRegions[missing[m]]);
+
+      // Engines may change the thresholds as they read them (Tesseract inverts them in place).  Put them
+      // back afterwards, so the next line is hashed and read the same way whether or not this one was cached
+      vector<Mat> savedThresholds(pipeline_data->thresholds.size());
+      for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
+        pipeline_data->thresholds[i].copyTo(savedThresholds[i]);
+
+      pipeline_data->charRegions[line_idx] = missingRegions;
+      vector<OcrChar> recognized = recognize_line(line_idx, pipeline_data);
+      pipeline_data->charRegions[line_idx] = charRegions;
+
+      for (unsigned int i = 0; i < savedThresholds.size(); i++)
+        savedThresholds[i].copyTo(pipeline_data->thresholds[i]);
+
+      for (unsigned int c = 0; c < recognized.size(); c++)
+        char_results[missing[recognized[c].char_index]].push_back(recognized[c]);
+
+      for (unsigned int m = 0; m < missing.size(); m++)
+        cache->store(charRegions[missing[m]].size(), hashes[missing[m]], char_results[missing[m]]);
+    }
+
+    if (config->debugOcr)
+      cout << "OCR cache: " << (charRegions.size() - missing.size()) << " of " << charRegions.size() << " characters found.  "
+           << cache->getHits() << " hits, " << cache->getMisses() << " misses overall" << endl;
+
+    vector<OcrChar> chars;
+    for (unsigned int j = 0; j < char_results.size(); j++)
+    {
+      for (unsigned int c = 0; c < char_results[j].size(); c++)
+      {
+        OcrChar ocr_char = char_results[j][c];
+        ocr_char.char_index = j;
+        chars.push_back(ocr_char);
+      }
+    }
+
+    return chars;
+  }
+}
@@ -32,6 +32,8 @@ namespace alpr
     float confidence;
   };
   
+  class OcrCache;
+
   class OCR {
   public:
     OCR(Config* config);
@@ -39,6 +41,9 @@ namespace alpr
 
     void performOCR(PipelineData* pipeline_data);
 
+    // Engines are shared between Alpr instances.  The borrower's config supplies the runtime settings
+    void setConfig(Config* config);
+
     PostProcess postProcessor;
 
   protected:
@@ -47,6 +52,12 @@ namespace alpr
     
     Config* config;
 
+  private:
+    // Created when ocr_cache is first enabled
+    OcrCache* cache;
+
+    std::vector<OcrChar> recognize_line_cached(int line_index, PipelineData* pipeline_data);
+
   };
 }
 
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ocrcache.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  const int HASH_SIZE = 8;
+
+  static int countBits(uint64_t value)
+  {
+    int bits = 0;
+    while (value != 0)
+    {
+      value &= value - 1;
+      bits++;
+    }
+    return bits;
+  }
+
+  OcrCache::OcrCache(int capacity, int max_distance)
+  {
+    this->capacity = capacity;
+    this->max_distance = max_distance;
+    this->hits = 0;
+    this->misses = 0;
+  }
+
+  OcrCache::~OcrCache()
+  {
+  }
+
+  bool OcrCache::lookup(cv::Size crop_size, const std::vector<uint64_t>& hashes, std::vector<OcrChar>* chars)
+  {
+    for (list<CacheEntry>::iterator it = entries.begin(); it != entries.end(); it++)
+    {
+      if (!matches(*it, crop_size, hashes))
+        continue;
+
+      *chars = it->chars;
+
+      // Move it to the front
+      entries.splice(entries.begin(), entries, it);
+      hits++;
+      return true;
+    }
+
+    misses++;
+    return false;
+  }
+
+  void OcrCache::store(cv::Size crop_size, const std::vector<uint64_t>& hashes, const std::vector<OcrChar>& chars)
+  {
+    if (capacity <= 0)
+      return;
+
+    CacheEntry entry;
+    entry.crop_size = crop_size;
+    entry.hashes = hashes;
+    entry.chars = chars;
+    entries.push_front(entry);
+
+    while ((int) entries.size() > capacity)
+      entries.pop_back();
+  }
+
+  uint64_t OcrCache::hashCrop(const cv::Mat& crop)
+  {
+    if (crop.empty())
+      return 0;
+
+    Mat small;
+    resize(crop, small, Size(HASH_SIZE, HASH_SIZE), 0, 0, INTER_AREA);
+
+    int total = 0;
+    for (int y = 0; y < HASH_SIZE; y++)
+    {
+      for (int x = 0; x < HASH_SIZE; x++)
+        total += small.at<uchar>(y, x);
+    }
+    int mean = total / (HASH_SIZE * HASH_SIZE);
+
+    uint64_t hash = 0;
+    for (int y = 0; y < HASH_SIZE; y++)
+    {
+      for (int x = 0; x < HASH_SIZE; x++)
+      {
+        hash <<= 1;
+        if (small.at<uchar>(y, x) > mean)
+          hash |= 1;
+      }
+    }
+
+    return hash;
+  }
+
+  int64_t OcrCache::getHits()
+  {
+    return hits;
+  }
+
+  int64_t OcrCache::getMisses()
+  {
+    return misses;
+  }
+
+  bool OcrCache::matches(const CacheEntry& entry, cv::Size crop_size, const std::vector<uint64_t>& hashes)
+  {
+    // The hash is taken at a fixed size, so it can't tell a narrow crop (1, I) from a wide one on its own
+    if (entry.crop_size != crop_size || entry.hashes.size() != hashes.size())
+      return false;
+
+    for (unsigned int i = 0; i < hashes.size(); i++)
+    {
+      if (countBits(entry.hashes[i] ^ hashes[i]) > max_distance)
+        return false;
+    }
+
+    return true;
+  }
+
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_OCRCACHE_H
+#define OPENALPR_OCRCACHE_H
+
+#include <list>
+#include <stdint.h>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+#include "ocr.h"
+
+namespace alpr
+{
+
+  // Remembers the OCR choices for recently seen characters.  In video the same plate is read
+  // frame after frame, and its binarized character crops barely change, so each character is
+  // identified by the size of its crop and a perceptual hash of the crop in every threshold.  A
+  // character matches a cached one when the crops are the same size and every hash is within
+  // max_distance bits.  Similar glyphs (8 and B, 0 and D) are only a few bits apart, so max_distance
+  // should stay at 0 or 1.  The least recently used entry is dropped once the cache is full.
+  //
+  // Not thread safe.  Each OCR instance has its own.
+  class OcrCache
+  {
+    public:
+      OcrCache(int capacity, int max_distance);
+      virtual ~OcrCache();
+
+      // Fills chars with the cached choices for the character.  Returns false if it isn't cached
+      bool lookup(cv::Size crop_size, const std::vector<uint64_t>& hashes, std::vector<OcrChar>* chars);
+
+      void store(cv::Size crop_size, const std::vector<uint64_t>& hashes, const std::vector<OcrChar>& chars);
+
+      // 64 bit average hash of the crop shrunk to 8x8
+      static uint64_t hashCrop(const cv::Mat& crop);
+
+      int64_t getHits();
+      int64_t getMisses();
+
+    private:
+
+      struct CacheEntry
+      {
+        cv::Size crop_size;
+        std::vector<uint64_t> hashes;
+        std::vector<OcrChar> chars;
+      };
+
+      // Most recently used first
+      std::list<CacheEntry> entries;
+      int capacity;
+      int max_distance;
+
+      int64_t hits;
+      int64_t misses;
+
+      bool matches(const CacheEntry& entry, cv::Size crop_size, const std::vector<uint64_t>& hashes);
+  };
+
+}
+
+#endif // OPENALPR_OCRCACHE_H
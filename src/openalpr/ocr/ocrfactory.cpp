@@ -1,10 +1,14 @@
 #include "ocrfactory.h"
 #include "tesseract_ocr.h"
+#include "knn_ocr.h"
 
 namespace alpr
 {
   OCR* createOcr(Config* config)
   {
+    if (config->ocrEngine == OCR_KNN)
+      return new KnnOcr(config);
+
     return new TesseractOcr(config);
   }
 
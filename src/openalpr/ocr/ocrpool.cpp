@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ocrpool.h"
+#include "ocrfactory.h"
+
+namespace alpr
+{
+
+  OcrPool::OcrPool(Config* config, unsigned int initial_size)
+  {
+    this->config = config;
+
+    if (initial_size < 1)
+      initial_size = 1;
+
+    for (unsigned int i = 0; i < initial_size; i++)
+    {
+      OCR* ocr = createOcr(config);
+      instances.push_back(ocr);
+      available.push_back(ocr);
+    }
+
+    primaryInstance = instances[0];
+  }
+
+  OcrPool::~OcrPool()
+  {
+    for (unsigned int i = 0; i < instances.size(); i++)
+      delete instances[i];
+  }
+
+  OCR* OcrPool::acquire(Config* config)
+  {
+    OCR* ocr = NULL;
+
+    mMutex.lock();
+    if (available.size() > 0)
+    {
+      ocr = available.back();
+      available.pop_back();
+    }
+    mMutex.unlock();
+
+    if (ocr == NULL)
+    {
+      // Every engine is busy.  Loading another is slow, so don't hold the lock while doing it
+      ocr = createOcr(this->config);
+
+      tthread::lock_guard<tthread::mutex> guard(mMutex);
+      instances.push_back(ocr);
+    }
+
+    ocr->setConfig(config);
+    return ocr;
+  }
+
+  void OcrPool::release(OCR* ocr)
+  {
+    // Don't leave the engine pointing at a config that may be deleted before the next borrower
+    ocr->setConfig(config);
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    available.push_back(ocr);
+  }
+
+  OCR* OcrPool::primary()
+  {
+    return primaryInstance;
+  }
+
+  unsigned int OcrPool::size()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+    return instances.size();
+  }
+
+  OcrGuard::OcrGuard(OcrPool* pool, Config* config)
+  {
+    this->pool = pool;
+    this->ocr = pool->acquire(config);
+  }
+
+  OcrGuard::~OcrGuard()
+  {
+    release();
+  }
+
+  OCR* OcrGuard::get()
+  {
+    return ocr;
+  }
+
+  void OcrGuard::release()
+  {
+    if (ocr == NULL)
+      return;
+
+    pool->release(ocr);
+    ocr = NULL;
+  }
+
+}
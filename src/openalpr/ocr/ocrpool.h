@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_OCRPOOL_H
+#define	OPENALPR_OCRPOOL_H
+
+#include <vector>
+
+#include "config.h"
+#include "ocr.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Hands out OCR instances to plate analysis workers.  Tesseract and the postprocessor
+  // both hold per-plate state, so an instance is only used by one thread at a time.
+  // The pool starts with a single engine and loads another only when every engine is busy,
+  // so the number of engines tracks peak concurrency rather than the number of threads.
+  class OcrPool
+  {
+    public:
+      OcrPool(Config* config, unsigned int initial_size);
+      virtual ~OcrPool();
+
+      // Never blocks.  The engine reads its runtime settings from config until it is released
+      OCR* acquire(Config* config);
+      void release(OCR* ocr);
+
+      // The first instance created.  Useful for read-only queries (e.g., patterns)
+      OCR* primary();
+
+      unsigned int size();
+
+    private:
+      // Config used to load new engines
+      Config* config;
+
+      OCR* primaryInstance;
+      std::vector<OCR*> instances;
+      std::vector<OCR*> available;
+
+      tthread::mutex mMutex;
+  };
+
+  // Borrows an engine until release() or the end of the guard's scope, so it goes back to the pool
+  // even if OCR or postprocessing throws
+  class OcrGuard
+  {
+    public:
+      OcrGuard(OcrPool* pool, Config* config);
+      virtual ~OcrGuard();
+
+      OCR* get();
+
+      // Returns the engine early.  get() is NULL afterwards
+      void release();
+
+    private:
+      OcrPool* pool;
+      OCR* ocr;
+
+      OcrGuard(const OcrGuard&);
+      OcrGuard& operator=(const OcrGuard&);
+  };
+
+}
+
+#endif	/* OPENALPR_OCRPOOL_H */
@@ -60,8 +60,9 @@ namespace alpr
   
   std::vector<OcrChar> TesseractOcr::recognize_line(int line_idx, PipelineData* pipeline_data) {
 
-    const int SPACE_CHAR_CODE = 32;
-    
+    if (config->ocrBatchLine)
+      return recognize_line_tiled(line_idx, pipeline_data);
+
     std::vector<OcrChar> recognized_chars;
     
     for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
@@ -86,64 +87,7 @@ namespace alpr
         tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
         do
         {
-          const char* symbol = ri->GetUTF8Text(level);
-          float conf = ri->Confidence(level);
-
-          bool dontcare;
-          int fontindex = 0;
-          int pointsize = 0;
-          const char* fontName = ri->WordFontAttributes(&dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &pointsize, &fontindex);
-
-          // Ignore NULL pointers, spaces, and characters that are way too small to be valid
-          if(symbol != 0 && symbol[0] != SPACE_CHAR_CODE && pointsize >= config->ocrMinFontSize)
-          {
-            OcrChar c;
-            c.char_index = absolute_charpos;
-            c.confidence = conf;
-            c.letter = string(symbol);
-            recognized_chars.push_back(c);
-
-            if (this->config->debugOcr)
-              printf("charpos%d line%d: threshold %d:  symbol %s, conf: %f font: %s (index %d) size %dpx", absolute_charpos, line_idx, i, symbol, conf, fontName, fontindex, pointsize);
-
-            bool indent = false;
-            tesseract::ChoiceIterator ci(*ri);
-            do
-            {
-              const char* choice = ci.GetUTF8Text();
-              
-              OcrChar c2;
-              c2.char_index = absolute_charpos;
-              c2.confidence = ci.Confidence();
-              c2.letter = string(choice);
-              
-              //1/17/2016 adt adding check to avoid double adding same character if ci is same as symbol. Otherwise first choice from ResultsIterator will get added twice when choiceIterator run.
-              if (string(symbol) != string(choice))
-                recognized_chars.push_back(c2);
-              else
-              {
-                // Explictly double-adding the first character.  This leads to higher accuracy right now, likely because other sections of code
-                // have expected it and compensated. 
-                // TODO: Figure out how to remove this double-counting of the first letter without impacting accuracy
-                recognized_chars.push_back(c2);
-              }
-              if (this->config->debugOcr)
-              {
-                if (indent) printf("\t\t ");
-                printf("\t- ");
-                printf("%s conf: %f\n", choice, ci.Confidence());
-              }
-
-              indent = true;
-            }
-            while(ci.Next());
-
-          }
-
-          if (this->config->debugOcr)
-            printf("---------------------------------------------\n");
-
-          delete[] symbol;
+          readSymbol(ri, absolute_charpos, line_idx, i, &recognized_chars);
         }
         while((ri->Next(level)));
 
@@ -156,6 +100,157 @@ namespace alpr
     
     return recognized_chars;
   }
+
+  // Pastes every character box of every threshold into one image (a row per threshold, a column per
+  // character, separated by blank space) so that Tesseract only runs once for the line.  Each
+  // symbol it finds belongs to the character whose tile holds the center of the symbol.
+  std::vector<OcrChar> TesseractOcr::recognize_line_tiled(int line_idx, PipelineData* pipeline_data) {
+
+    std::vector<OcrChar> recognized_chars;
+
+    const std::vector<Rect>& charRegions = pipeline_data->charRegions[line_idx];
+    int num_thresholds = pipeline_data->thresholds.size();
+    int num_chars = charRegions.size();
+    if (num_thresholds == 0 || num_chars == 0)
+      return recognized_chars;
+
+    // Every tile gets the same size, so the tiles line up in rows Tesseract can follow
+    vector<Rect> expandedRegions;
+    int tile_width = 0;
+    int tile_height = 0;
+    for (int j = 0; j < num_chars; j++)
+    {
+      Rect expandedRegion = expandRect(charRegions[j], 2, 2, pipeline_data->thresholds[0].cols, pipeline_data->thresholds[0].rows);
+      expandedRegions.push_back(expandedRegion);
+      tile_width = max(tile_width, expandedRegion.width);
+      tile_height = max(tile_height, expandedRegion.height);
+    }
+
+    // Enough space that neighboring characters are never read as one word
+    int gutter = max(tile_height / 2, 8);
+    int cell_width = tile_width + gutter;
+    int cell_height = tile_height + gutter;
+
+    // White background, black text
+    Mat tiled(gutter + num_thresholds * cell_height, gutter + num_chars * cell_width, CV_8U, Scalar(255));
+    vector<Rect> tiles;
+    for (int i = 0; i < num_thresholds; i++)
+    {
+      for (int j = 0; j < num_chars; j++)
+      {
+        Rect tile(gutter + j * cell_width, gutter + i * cell_height, expandedRegions[j].width, expandedRegions[j].height);
+        Mat tileImage = tiled(tile);
+        bitwise_not(pipeline_data->thresholds[i](expandedRegions[j]), tileImage);
+        tiles.push_back(tile);
+      }
+    }
+
+    tesseract.SetPageSegMode(PSM_SPARSE_TEXT);
+    tesseract.SetImage((uchar*) tiled.data, tiled.cols, tiled.rows, tiled.channels(), tiled.step1());
+    tesseract.Recognize(NULL);
+
+    // Group the symbols by tile, so they come out in the same order as one call per character would give
+    vector<vector<OcrChar> > tile_chars(tiles.size());
+
+    tesseract::ResultIterator* ri = tesseract.GetIterator();
+    tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
+    if (ri != NULL && !ri->Empty(level))
+    {
+      do
+      {
+        int left, top, right, bottom;
+        if (!ri->BoundingBox(level, &left, &top, &right, &bottom))
+          continue;
+
+        Point center((left + right) / 2, (top + bottom) / 2);
+        for (unsigned int t = 0; t < tiles.size(); t++)
+        {
+          if (tiles[t].contains(center))
+          {
+            readSymbol(ri, t % num_chars, line_idx, t / num_chars, &tile_chars[t]);
+            break;
+          }
+        }
+      }
+      while((ri->Next(level)));
+    }
+    delete ri;
+
+    tesseract.SetPageSegMode(PSM_SINGLE_CHAR);
+
+    for (unsigned int t = 0; t < tile_chars.size(); t++)
+      recognized_chars.insert(recognized_chars.end(), tile_chars[t].begin(), tile_chars[t].end());
+
+    return recognized_chars;
+  }
+
+  // Adds the symbol at the iterator, and its alternatives, as candidates for the character position
+  void TesseractOcr::readSymbol(tesseract::ResultIterator* ri, int char_index, int line_idx, int threshold_idx, std::vector<OcrChar>* recognized_chars) {
+
+    const int SPACE_CHAR_CODE = 32;
+
+    tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
+
+    const char* symbol = ri->GetUTF8Text(level);
+    float conf = ri->Confidence(level);
+
+    bool dontcare;
+    int fontindex = 0;
+    int pointsize = 0;
+    const char* fontName = ri->WordFontAttributes(&dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &pointsize, &fontindex);
+
+    // Ignore NULL pointers, spaces, and characters that are way too small to be valid
+    if(symbol != 0 && symbol[0] != SPACE_CHAR_CODE && pointsize >= config->ocrMinFontSize)
+    {
+      OcrChar c;
+      c.char_index = char_index;
+      c.confidence = conf;
+      c.letter = string(symbol);
+      recognized_chars->push_back(c);
+
+      if (this->config->debugOcr)
+        printf("charpos%d line%d: threshold %d:  symbol %s, conf: %f font: %s (index %d) size %dpx", char_index, line_idx, threshold_idx, symbol, conf, fontName, fontindex, pointsize);
+
+      bool indent = false;
+      tesseract::ChoiceIterator ci(*ri);
+      do
+      {
+        const char* choice = ci.GetUTF8Text();
+        
+        OcrChar c2;
+        c2.char_index = char_index;
+        c2.confidence = ci.Confidence();
+        c2.letter = string(choice);
+        
+        //1/17/2016 adt adding check to avoid double adding same character if ci is same as symbol. Otherwise first choice from ResultsIterator will get added twice when choiceIterator run.
+        if (string(symbol) != string(choice))
+          recognized_chars->push_back(c2);
+        else
+        {
+          // Explictly double-adding the first character.  This leads to higher accuracy right now, likely because other sections of code
+          // have expected it and compensated. 
+          // TODO: Figure out how to remove this double-counting of the first letter without impacting accuracy
+          recognized_chars->push_back(c2);
+        }
+        if (this->config->debugOcr)
+        {
+          if (indent) printf("\t\t ");
+          printf("\t- ");
+          printf("%s conf: %f\n", choice, ci.Confidence());
+        }
+
+        indent = true;
+      }
+      while(ci.Next());
+
+    }
+
+    if (this->config->debugOcr)
+      printf("---------------------------------------------\n");
+
+    delete[] symbol;
+  }
+
   void TesseractOcr::segment(PipelineData* pipeline_data) {
 
     CharacterSegmenter segmenter(pipeline_data);
@@ -49,6 +49,8 @@ namespace alpr
     private:
 
       std::vector<OcrChar> recognize_line(int line_index, PipelineData* pipeline_data);
+      std::vector<OcrChar> recognize_line_tiled(int line_index, PipelineData* pipeline_data);
+      void readSymbol(tesseract::ResultIterator* ri, int char_index, int line_idx, int threshold_idx, std::vector<OcrChar>* recognized_chars);
       void segment(PipelineData* pipeline_data);
     
       tesseract::TessBaseAPI tesseract;
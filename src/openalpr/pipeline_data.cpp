@@ -41,14 +41,49 @@ namespace alpr
     thresholds.clear();
   }
 
+  double PipelineData::addStageTime(ALPR_STAGE stage, timespec startTime)
+  {
+    if (stage_times != NULL)
+      return stage_times->addTimeSince(stage, startTime);
+
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    return diffclock(startTime, endTime);
+  }
+
+  void PipelineData::addCount(std::string counter, int64_t count)
+  {
+    if (stage_times != NULL)
+      stage_times->addCount(counter, count);
+  }
+
+  cv::Mat PipelineData::getImage(cv::Size size, int type)
+  {
+    if (arena != NULL)
+      return arena->get(size, type);
+
+    return Mat(size, type);
+  }
+
+  cv::Mat PipelineData::getZeroImage(cv::Size size, int type)
+  {
+    if (arena != NULL)
+      return arena->zeros(size, type);
+
+    return Mat::zeros(size, type);
+  }
+
   void PipelineData::init(cv::Mat colorImage, cv::Mat grayImage, cv::Rect regionOfInterest, Config *config) {
     this->colorImg = colorImage;
     this->grayImg = grayImage;
     this->regionOfInterest = regionOfInterest;
     this->config = config;
+    this->stage_times = NULL;
+    this->arena = NULL;
     this->region_confidence = 0;
     this->plate_inverted = false;
     this->disqualified = false;
     this->disqualify_reason = "";
+    this->disqualify_stage = "";
   }
 }
@@ -8,6 +8,8 @@
 #include "textdetection/textline.h"
 #include "edges/scorekeeper.h"
 #include "prewarp.h"
+#include "stage_stats.h"
+#include "mat_arena.h"
 
 namespace alpr
 {
@@ -23,11 +25,28 @@ namespace alpr
       void init(cv::Mat colorImage, cv::Mat grayImage, cv::Rect regionOfInterest, Config* config);
       void clearThresholds();
 
+      // Adds the time since startTime to the stage.  Returns the elapsed time in ms
+      double addStageTime(ALPR_STAGE stage, timespec startTime);
+
+      // Adds to one of the Alpr instance's counters (see Alpr::getStats)
+      void addCount(std::string counter, int64_t count);
+
+      // An image for this plate, recycled from an earlier plate when possible.
+      // The contents of getImage() are undefined.  getZeroImage() is cleared
+      cv::Mat getImage(cv::Size size, int type);
+      cv::Mat getZeroImage(cv::Size size, int type);
+
       // Inputs
       Config* config;
 
       PreWarp* prewarp;
 
+      // Where the time spent in each stage is recorded.  May be NULL
+      StageTimes* stage_times;
+
+      // Where getImage() finds reusable images.  May be NULL
+      MatArena* arena;
+
       cv::Mat colorImg;
       cv::Mat grayImg;
       cv::Rect regionOfInterest;
@@ -55,6 +74,9 @@ namespace alpr
 
       bool disqualified;
       std::string disqualify_reason;
+
+      // The stage of the analysis that disqualified the plate (e.g., "character_analysis")
+      std::string disqualify_stage;
       
       ScoreKeeper confidence_weights;
 
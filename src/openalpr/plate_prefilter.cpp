@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "plate_prefilter.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  // Contrast is measured between the darkest and brightest pixels, ignoring this fraction at either end
+  const float CONTRAST_OUTLIER_FRACTION = 0.05;
+
+  // Horizontal gradient (3x3 Sobel) a pixel needs to count as part of a character stroke edge
+  const int EDGE_STRENGTH = 100;
+
+  PlatePrefilter::PlatePrefilter(PipelineData* pipeline_data)
+  {
+    this->pipeline_data = pipeline_data;
+    this->config = pipeline_data->config;
+  }
+
+  PlatePrefilter::~PlatePrefilter()
+  {
+  }
+
+  bool PlatePrefilter::filter()
+  {
+    if (!config->prefilter)
+      return true;
+
+    timespec startTime;
+    getTimeMonotonic(&startTime);
+
+    Mat crop = pipeline_data->crop_gray;
+    int total_pixels = crop.rows * crop.cols;
+    if (total_pixels == 0)
+      return true;
+
+    // Contrast: text is much darker (or lighter) than the plate behind it
+    int histogram[256] = {0};
+    for (int y = 0; y < crop.rows; y++)
+    {
+      const unsigned char* row = crop.ptr<unsigned char>(y);
+      for (int x = 0; x < crop.cols; x++)
+        histogram[row[x]]++;
+    }
+
+    int outliers = total_pixels * CONTRAST_OUTLIER_FRACTION;
+    int darkest = 0, brightest = 255;
+    for (int count = 0; darkest < 255 && count + histogram[darkest] <= outliers; darkest++)
+      count += histogram[darkest];
+    for (int count = 0; brightest > 0 && count + histogram[brightest] <= outliers; brightest--)
+      count += histogram[brightest];
+
+    bool passed = true;
+    if (brightest - darkest < config->prefilterMinContrast)
+    {
+      disqualify("prefilter_contrast", "Low contrast in prefilter");
+      passed = false;
+    }
+
+    // Variance: a plate isn't mostly one shade with a few stray pixels
+    if (passed)
+    {
+      Scalar mean, stddev;
+      meanStdDev(crop, mean, stddev);
+
+      if (stddev[0] < config->prefilterMinStdDev)
+      {
+        disqualify("prefilter_variance", "Low variance in prefilter");
+        passed = false;
+      }
+    }
+
+    // Edge density: characters are made of vertical strokes.  Too few edges is a blank area,
+    // too many is foliage, gravel and the like
+    if (passed)
+    {
+      Mat gradient;
+      Sobel(crop, gradient, CV_16S, 1, 0, 3);
+
+      int edge_pixels = 0;
+      for (int y = 0; y < gradient.rows; y++)
+      {
+        const short* row = gradient.ptr<short>(y);
+        for (int x = 0; x < gradient.cols; x++)
+        {
+          if (row[x] >= EDGE_STRENGTH || row[x] <= -EDGE_STRENGTH)
+            edge_pixels++;
+        }
+      }
+
+      float edge_density = ((float) edge_pixels) / ((float) total_pixels);
+      if (edge_density < config->prefilterMinEdgeDensity)
+      {
+        disqualify("prefilter_edges", "Too few edges in prefilter");
+        passed = false;
+      }
+      else if (edge_density > config->prefilterMaxEdgeDensity)
+      {
+        disqualify("prefilter_edges", "Too many edges in prefilter");
+        passed = false;
+      }
+    }
+
+    if (config->debugTiming)
+    {
+      timespec endTime;
+      getTimeMonotonic(&endTime);
+      cout << "Prefilter Time: " << diffclock(startTime, endTime) << "ms." << endl;
+    }
+
+    return passed;
+  }
+
+  void PlatePrefilter::disqualify(std::string stage, std::string reason)
+  {
+    pipeline_data->disqualified = true;
+    pipeline_data->disqualify_stage = stage;
+    pipeline_data->disqualify_reason = reason;
+  }
+
+}
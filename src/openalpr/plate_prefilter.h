@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_PLATEPREFILTER_H
+#define OPENALPR_PLATEPREFILTER_H
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "config.h"
+#include "pipeline_data.h"
+
+namespace alpr
+{
+
+  // Quick tests that reject plate regions which can't hold any text, before the (much more
+  // expensive) character analysis runs on them.  The tests run on the template sized crop,
+  // cheapest first, and the region is disqualified by the first one it fails.
+  class PlatePrefilter
+  {
+    public:
+      PlatePrefilter(PipelineData* pipeline_data);
+      virtual ~PlatePrefilter();
+
+      // Returns false, and disqualifies the region, if crop_gray can't be a plate
+      bool filter();
+
+    private:
+      PipelineData* pipeline_data;
+      Config* config;
+
+      void disqualify(std::string stage, std::string reason);
+  };
+
+}
+
+#endif // OPENALPR_PLATEPREFILTER_H
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "plate_tracker.h"
+
+#include "utility.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  // Readings of a moving plate may differ by a couple of OCR mistakes and still be the same plate
+  const int MAX_TRACK_TEXT_DISTANCE = 2;
+
+  // How far around a track's predicted position to search, as a multiple of the plate's size
+  const float TRACK_SEARCH_WIDTH_MULTIPLE = 3.0;
+  const float TRACK_SEARCH_HEIGHT_MULTIPLE = 4.0;
+
+  // A plate that never leaves the view (e.g., a parked car) would otherwise be tracked forever.
+  // Its track is ended after this long and a new one starts with the next reading
+  const int MAX_TRACK_DURATION_MS = 60000;
+
+  // Only the most confident readings of a track take part in the vote
+  const unsigned int MAX_TRACK_READINGS = 30;
+
+  PlateTracker::PlateTracker(Config* config, int topn, int track_timeout_ms)
+    : aggregator(MERGE_COMBINE, topn, config)
+  {
+    this->config = config;
+    this->track_timeout_ms = track_timeout_ms;
+    this->next_track_id = 1;
+  }
+
+  PlateTracker::~PlateTracker()
+  {
+  }
+
+  std::vector<PlateGroup> PlateTracker::addFrame(AlprResults results, int64_t frame_time, std::string frame_tag)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    vector<PlateGroup> groups = endTracks(frame_time);
+
+    // Each track takes at most one plate from a frame
+    vector<bool> matched(tracks.size(), false);
+    vector<AlprPlateResult> unmatched_plates;
+
+    for (unsigned int i = 0; i < results.plates.size(); i++)
+    {
+      int track_index = findTrack(results.plates[i], frame_time, matched);
+
+      if (track_index < 0)
+      {
+        unmatched_plates.push_back(results.plates[i]);
+      }
+      else
+      {
+        addReading(&tracks[track_index], results.plates[i], frame_time, frame_tag);
+        matched[track_index] = true;
+      }
+    }
+
+    for (unsigned int i = 0; i < unmatched_plates.size(); i++)
+    {
+      PlateTrack track;
+      track.id = next_track_id++;
+      track.frame_count = 0;
+      track.first_time = frame_time;
+      track.last_time = frame_time;
+      track.last_reading = unmatched_plates[i];
+      track.velocity = Point2f(0, 0);
+      track.best_confidence = -1;
+
+      addReading(&track, unmatched_plates[i], frame_time, frame_tag);
+      tracks.push_back(track);
+    }
+
+    if (config->debugGeneral)
+      cout << "Plate tracker: " << results.plates.size() << " plates, " << unmatched_plates.size() << " new tracks, "
+           << tracks.size() << " active tracks, " << groups.size() << " ended" << endl;
+
+    return groups;
+  }
+
+  std::vector<PlateGroup> PlateTracker::expireTracks(int64_t now)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    return endTracks(now);
+  }
+
+  std::vector<PlateGroup> PlateTracker::flush()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    vector<PlateGroup> groups;
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      PlateGroup group;
+      if (endTrack(&tracks[i], &group))
+        groups.push_back(group);
+    }
+    tracks.clear();
+
+    return groups;
+  }
+
+  std::vector<cv::Rect> PlateTracker::predictRegions(int64_t frame_time, int img_width, int img_height)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    vector<Rect> regions;
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      if (tracks[i].last_time < frame_time - track_timeout_ms)
+        continue;
+
+      AlprPlateResult predicted = predictPosition(&tracks[i], frame_time);
+      PlateShapeInfo shape = ResultAggregator::getShapeInfo(predicted);
+
+      int search_width = shape.max_width * TRACK_SEARCH_WIDTH_MULTIPLE;
+      int search_height = shape.max_height * TRACK_SEARCH_HEIGHT_MULTIPLE;
+      Rect region(shape.center.x - search_width / 2, shape.center.y - search_height / 2, search_width, search_height);
+      region = expandRect(region, 0, 0, img_width, img_height);
+
+      if (region.area() > 0)
+        regions.push_back(region);
+    }
+
+    // Merge overlapping regions so that no part of the frame is searched twice
+    return mergeOverlappingRects(regions);
+  }
+
+  std::vector<cv::Rect> PlateTracker::addTrackedRegions(std::vector<cv::Rect> regions, int64_t frame_time, int img_width, int img_height)
+  {
+    vector<Rect> tracked = predictRegions(frame_time, img_width, img_height);
+    regions.insert(regions.end(), tracked.begin(), tracked.end());
+
+    return removeContainedRects(regions);
+  }
+
+  int PlateTracker::activeTracks()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    return tracks.size();
+  }
+
+  // Returns the index of the unmatched track that best fits the plate, or -1 if none do
+  int PlateTracker::findTrack(AlprPlateResult plate, int64_t frame_time, std::vector<bool>& matched)
+  {
+    int best_index = -1;
+    int best_distance = MAX_TRACK_TEXT_DISTANCE + 1;
+
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      if (matched[i])
+        continue;
+
+      int distance = levenshteinDistance(plate.bestPlate.characters, tracks[i].last_reading.bestPlate.characters,
+                                         MAX_TRACK_TEXT_DISTANCE + 1);
+
+      // A plate that reads identically is the same plate, even if it moved further than expected.
+      // Otherwise it must be close in both position and text
+      bool same_text = (distance == 0);
+      bool near_prediction = ResultAggregator::platesOverlap(plate, predictPosition(&tracks[i], frame_time));
+
+      if (!same_text && !(near_prediction && distance <= MAX_TRACK_TEXT_DISTANCE))
+        continue;
+
+      if (best_index < 0 || distance < best_distance)
+      {
+        best_index = i;
+        best_distance = distance;
+      }
+    }
+
+    return best_index;
+  }
+
+  void PlateTracker::addReading(PlateTrack* track, AlprPlateResult plate, int64_t frame_time, std::string frame_tag)
+  {
+    track->frame_count++;
+    track->readings.push_back(plate);
+
+    // Replace the least confident reading once the track is full
+    if (track->readings.size() > MAX_TRACK_READINGS)
+    {
+      unsigned int worst_index = 0;
+      for (unsigned int i = 1; i < track->readings.size(); i++)
+      {
+        if (track->readings[i].bestPlate.overall_confidence < track->readings[worst_index].bestPlate.overall_confidence)
+          worst_index = i;
+      }
+      track->readings.erase(track->readings.begin() + worst_index);
+    }
+
+    if (frame_time < track->first_time)
+      track->first_time = frame_time;
+
+    // Frames analyzed in parallel can finish out of order.  Only a newer frame moves the track forward
+    if (frame_time > track->last_time)
+    {
+      PlateShapeInfo previous = ResultAggregator::getShapeInfo(track->last_reading);
+      PlateShapeInfo current = ResultAggregator::getShapeInfo(plate);
+      float elapsed = frame_time - track->last_time;
+
+      track->velocity = Point2f((current.center.x - previous.center.x) / elapsed,
+                                (current.center.y - previous.center.y) / elapsed);
+      track->last_time = frame_time;
+      track->last_reading = plate;
+    }
+
+    if (plate.bestPlate.overall_confidence > track->best_confidence)
+    {
+      track->best_confidence = plate.bestPlate.overall_confidence;
+      track->best_frame_tag = frame_tag;
+    }
+  }
+
+  // The track's last reading, moved to where it should be at frame_time
+  AlprPlateResult PlateTracker::predictPosition(PlateTrack* track, int64_t frame_time)
+  {
+    AlprPlateResult predicted = track->last_reading;
+
+    float elapsed = frame_time - track->last_time;
+    if (elapsed <= 0)
+      return predicted;
+
+    int offset_x = track->velocity.x * elapsed;
+    int offset_y = track->velocity.y * elapsed;
+    for (int i = 0; i < 4; i++)
+    {
+      predicted.plate_points[i].x += offset_x;
+      predicted.plate_points[i].y += offset_y;
+    }
+
+    return predicted;
+  }
+
+  // Ends every track that has not been seen within the timeout of now, or has lasted too long
+  std::vector<PlateGroup> PlateTracker::endTracks(int64_t now)
+  {
+    vector<PlateGroup> groups;
+    vector<PlateTrack> remaining;
+
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      bool timed_out = tracks[i].last_time < now - track_timeout_ms;
+      bool too_long = tracks[i].last_time - tracks[i].first_time >= MAX_TRACK_DURATION_MS;
+      if (!timed_out && !too_long)
+      {
+        remaining.push_back(tracks[i]);
+        continue;
+      }
+
+      PlateGroup group;
+      if (endTrack(&tracks[i], &group))
+        groups.push_back(group);
+    }
+
+    if (remaining.size() != tracks.size())
+      tracks = remaining;
+
+    return groups;
+  }
+
+  // Fuses the track's readings.  Returns false if none of them were confident enough to report
+  bool PlateTracker::endTrack(PlateTrack* track, PlateGroup* group)
+  {
+    AlprPlateResult combined;
+    if (!aggregator.combinePlates(track->readings, &combined))
+      return false;
+
+    // Report the plate where it was read best
+    for (unsigned int i = 0; i < track->readings.size(); i++)
+    {
+      if (track->readings[i].bestPlate.overall_confidence == track->best_confidence)
+      {
+        for (int p_idx = 0; p_idx < 4; p_idx++)
+          combined.plate_points[p_idx] = track->readings[i].plate_points[p_idx];
+        combined.country = track->readings[i].country;
+        break;
+      }
+    }
+
+    group->group_id = track->id;
+    group->start_time = track->first_time;
+    group->end_time = track->last_time;
+    group->frame_count = track->frame_count;
+    group->plate = combined;
+    group->best_frame_tag = track->best_frame_tag;
+
+    return true;
+  }
+
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_PLATETRACKER_H
+#define OPENALPR_PLATETRACKER_H
+
+#include <string>
+#include <vector>
+
+#include "alpr.h"
+#include "config.h"
+#include "result_aggregator.h"
+
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // All of the readings of one plate while it was in view, fused into a single result
+  struct PlateGroup
+  {
+    int group_id;
+
+    // Capture times (epoch ms) of the first and last frames the plate was seen in
+    int64_t start_time;
+    int64_t end_time;
+    int frame_count;
+
+    AlprPlateResult plate;
+
+    // Tag (supplied to addFrame) of the frame with the most confident reading
+    std::string best_frame_tag;
+  };
+
+  // Follows plates across consecutive video frames.  A plate is matched to an active track
+  // when it is near where the track is expected to be and reads similarly.  Once a track
+  // has not been seen for the timeout, or has lasted longer than the maximum track duration,
+  // its readings are combined with the same topN voting that ResultAggregator uses and reported
+  // as one PlateGroup.  Only the most confident readings of a long track are kept for the vote.
+  // Safe to use from several threads at once.  Frames may arrive slightly out of order.
+  class PlateTracker
+  {
+    public:
+      PlateTracker(Config* config, int topn, int track_timeout_ms);
+      virtual ~PlateTracker();
+
+      // Adds the plates recognized in a frame captured at frame_time.
+      // Returns the groups for any tracks that ended as of that time
+      std::vector<PlateGroup> addFrame(AlprResults results, int64_t frame_time, std::string frame_tag);
+
+      // Ends the tracks that have not been seen within the timeout of now
+      std::vector<PlateGroup> expireTracks(int64_t now);
+
+      // Ends every active track
+      std::vector<PlateGroup> flush();
+
+      // Areas where the active tracks should appear in a frame captured at frame_time.
+      // Overlapping areas are merged.  Empty if there are no active tracks
+      std::vector<cv::Rect> predictRegions(int64_t frame_time, int img_width, int img_height);
+
+      // The regions (e.g., from motion detection), plus the areas where the active tracks should appear.
+      // Areas that are already covered by another are left out
+      std::vector<cv::Rect> addTrackedRegions(std::vector<cv::Rect> regions, int64_t frame_time, int img_width, int img_height);
+
+      int activeTracks();
+
+    private:
+
+      struct PlateTrack
+      {
+        int id;
+
+        // The most confident readings, and how many frames the plate was read in altogether
+        std::vector<AlprPlateResult> readings;
+        int frame_count;
+
+        int64_t first_time;
+        int64_t last_time;
+
+        // The reading with the latest capture time, and its velocity in pixels per ms
+        AlprPlateResult last_reading;
+        cv::Point2f velocity;
+
+        float best_confidence;
+        std::string best_frame_tag;
+      };
+
+      Config* config;
+      int track_timeout_ms;
+      int next_track_id;
+
+      // Only used to combine readings.  Never holds results of its own
+      ResultAggregator aggregator;
+
+      std::vector<PlateTrack> tracks;
+
+      tthread::mutex mMutex;
+
+      int findTrack(AlprPlateResult plate, int64_t frame_time, std::vector<bool>& matched);
+      void addReading(PlateTrack* track, AlprPlateResult plate, int64_t frame_time, std::string frame_tag);
+      AlprPlateResult predictPosition(PlateTrack* track, int64_t frame_time);
+
+      std::vector<PlateGroup> endTracks(int64_t now);
+      bool endTrack(PlateTrack* track, PlateGroup* group);
+  };
+
+}
+
+#endif // OPENALPR_PLATETRACKER_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "countrypatterns.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "support/tinythread.h"
+
+using namespace std;
+
+tthread::mutex countrypatterns_mutex_m;
+
+namespace alpr
+{
+
+  // Guarded by countrypatterns_mutex_m
+  static map<string, CountryPatterns*> loaded_patterns;
+
+  CountryPatterns::CountryPatterns(string filename, string letters_regex, string numbers_regex, string key)
+  {
+    this->key = key;
+    this->references = 0;
+
+    std::ifstream infile(filename.c_str());
+
+    string region, pattern;
+    while (infile >> region >> pattern)
+    {
+      RegexRule* rule = new RegexRule(region, pattern, letters_regex, numbers_regex);
+      rules[region].push_back(rule);
+    }
+
+    map<string, vector<RegexRule*> >::iterator iter;
+    for (iter = rules.begin(); iter != rules.end(); ++iter)
+      compiled[iter->first] = new CompiledPatterns(iter->second);
+  }
+
+  CountryPatterns::~CountryPatterns()
+  {
+    map<string, CompiledPatterns*>::iterator compiled_iter;
+    for (compiled_iter = compiled.begin(); compiled_iter != compiled.end(); ++compiled_iter)
+      delete compiled_iter->second;
+
+    map<string, vector<RegexRule*> >::iterator iter;
+    for (iter = rules.begin(); iter != rules.end(); ++iter)
+    {
+      for (unsigned int i = 0; i < iter->second.size(); i++)
+        delete iter->second[i];
+    }
+  }
+
+  CountryPatterns* CountryPatterns::acquire(Config* config)
+  {
+    stringstream filename;
+    filename << config->getPostProcessRuntimeDir() << "/" << config->country << ".patterns";
+
+    string key = filename.str() + "|" + config->postProcessRegexLetters + "|" + config->postProcessRegexNumbers;
+
+    tthread::lock_guard<tthread::mutex> guard(countrypatterns_mutex_m);
+
+    CountryPatterns* patterns;
+    map<string, CountryPatterns*>::iterator it = loaded_patterns.find(key);
+    if (it == loaded_patterns.end())
+    {
+      patterns = new CountryPatterns(filename.str(), config->postProcessRegexLetters, config->postProcessRegexNumbers, key);
+      loaded_patterns[key] = patterns;
+    }
+    else
+    {
+      patterns = it->second;
+    }
+
+    patterns->references++;
+    return patterns;
+  }
+
+  void CountryPatterns::release(CountryPatterns* patterns)
+  {
+    tthread::lock_guard<tthread::mutex> guard(countrypatterns_mutex_m);
+
+    patterns->references--;
+    if (patterns->references == 0)
+    {
+      loaded_patterns.erase(patterns->key);
+      delete patterns;
+    }
+  }
+
+  const std::map<std::string, std::vector<RegexRule*> >& CountryPatterns::getRules()
+  {
+    return rules;
+  }
+
+  const CompiledPatterns* CountryPatterns::getCompiledPatterns(std::string region)
+  {
+    map<string, CompiledPatterns*>::iterator it = compiled.find(region);
+    if (it == compiled.end())
+      return NULL;
+
+    return it->second;
+  }
+
+}
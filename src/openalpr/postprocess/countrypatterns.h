@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_COUNTRYPATTERNS_H
+#define OPENALPR_COUNTRYPATTERNS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "regexrule.h"
+#include "patternmatcher.h"
+
+namespace alpr
+{
+
+  // The rules from a country's .patterns file, compiled once per process.
+  //
+  // Every PostProcess that loads the same patterns file with the same letter and number
+  // regexes shares a single, reference-counted copy.  The rules and compiled patterns are
+  // never modified after loading, so any number of threads can use them at once.
+  class CountryPatterns
+  {
+    public:
+
+      // Returns the patterns for the config's current country, loading them if required.
+      // Each acquire must be balanced by a release.
+      static CountryPatterns* acquire(Config* config);
+      static void release(CountryPatterns* patterns);
+
+      // Each region's rules, in the order they appear in the file
+      const std::map<std::string, std::vector<RegexRule*> >& getRules();
+
+      // All of the region's rules, compiled together.  NULL if the region has no rules
+      const CompiledPatterns* getCompiledPatterns(std::string region);
+
+    private:
+      CountryPatterns(std::string filename, std::string letters_regex, std::string numbers_regex, std::string key);
+      virtual ~CountryPatterns();
+
+      std::string key;
+      int references;
+
+      std::map<std::string, std::vector<RegexRule*> > rules;
+      std::map<std::string, CompiledPatterns*> compiled;
+  };
+
+}
+
+#endif // OPENALPR_COUNTRYPATTERNS_H
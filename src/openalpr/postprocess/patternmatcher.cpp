@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "patternmatcher.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace alpr
+{
+
+  const int ASCII_CHARS = 128;
+  const int BITS_PER_WORD = 64;
+
+  CompiledPatterns::CompiledPatterns(const std::vector<RegexRule*>& rules)
+  {
+    map<int, int> group_for_length;
+
+    for (unsigned int i = 0; i < rules.size(); i++)
+    {
+      // An invalid rule never matches anything
+      if (!rules[i]->isValid())
+        continue;
+
+      const vector<string>& regexes = rules[i]->getCharacterRegexes();
+
+      vector<int> pattern_regexes;
+      for (unsigned int k = 0; k < regexes.size(); k++)
+      {
+        int index = addCharRegex(regexes[k]);
+        if (index < 0)
+          break;
+
+        pattern_regexes.push_back(index);
+      }
+
+      if (regexes.size() == 0 || pattern_regexes.size() != regexes.size())
+      {
+        fallback_rules.push_back(rules[i]);
+        continue;
+      }
+
+      int length = regexes.size();
+      if (group_for_length.find(length) == group_for_length.end())
+      {
+        LengthGroup group;
+        group.length = length;
+        groups.push_back(group);
+        group_for_length[length] = groups.size() - 1;
+      }
+
+      groups[group_for_length[length]].pattern_regexes.push_back(pattern_regexes);
+    }
+
+    for (unsigned int i = 0; i < groups.size(); i++)
+      groups[i].words = (groups[i].pattern_regexes.size() + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  }
+
+  CompiledPatterns::~CompiledPatterns()
+  {
+    for (unsigned int i = 0; i < char_regexes.size(); i++)
+      delete char_regexes[i];
+  }
+
+  // Returns the index of the compiled regex, or -1 if it can't stand in for a single character
+  int CompiledPatterns::addCharRegex(const std::string& regex)
+  {
+    map<string, int>::iterator existing = char_regex_index.find(regex);
+    if (existing != char_regex_index.end())
+      return existing->second;
+
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    re2::RE2* compiled = new re2::RE2(regex, options);
+
+    // Anything that can match nothing (an anchor, "|", etc.) only means something as part of the whole regex
+    if (!compiled->ok() || re2::RE2::FullMatch("", *compiled))
+    {
+      delete compiled;
+      char_regex_index[regex] = -1;
+      return -1;
+    }
+
+    char_regexes.push_back(compiled);
+    char_regex_index[regex] = char_regexes.size() - 1;
+    return char_regexes.size() - 1;
+  }
+
+  PatternMatcher::PatternMatcher(const CompiledPatterns* patterns)
+  {
+    this->patterns = patterns;
+
+    states.resize(patterns->groups.size());
+    for (unsigned int i = 0; i < states.size(); i++)
+    {
+      const CompiledPatterns::LengthGroup& group = patterns->groups[i];
+      GroupState& state = states[i];
+
+      state.alive.resize(group.words);
+
+      state.positions.resize(group.length);
+      for (int p = 0; p < group.length; p++)
+      {
+        state.positions[p].ascii.resize(ASCII_CHARS, PatternMask(group.words, 0));
+        state.positions[p].ascii_known.resize(ASCII_CHARS, false);
+      }
+    }
+
+    reset();
+  }
+
+  PatternMatcher::~PatternMatcher()
+  {
+  }
+
+  void PatternMatcher::reset()
+  {
+    position = 0;
+    valid_utf8 = true;
+    any_alive = false;
+    candidate.clear();
+
+    for (unsigned int i = 0; i < states.size(); i++)
+    {
+      const CompiledPatterns::LengthGroup& group = patterns->groups[i];
+      GroupState& state = states[i];
+      int num_patterns = group.pattern_regexes.size();
+
+      for (int w = 0; w < group.words; w++)
+      {
+        int bits = min(BITS_PER_WORD, num_patterns - w * BITS_PER_WORD);
+        state.alive[w] = (bits == BITS_PER_WORD) ? ~((uint64_t) 0) : ((((uint64_t) 1) << bits) - 1);
+      }
+      state.any_alive = num_patterns > 0;
+      any_alive = any_alive || state.any_alive;
+    }
+  }
+
+  bool PatternMatcher::add(const std::string& characters)
+  {
+    const vector<RegexRule*>& fallback_rules = patterns->fallback_rules;
+
+    if (fallback_rules.size() > 0)
+      candidate += characters;
+
+    if (valid_utf8 && utf8::find_invalid(characters.begin(), characters.end()) != characters.end())
+    {
+      valid_utf8 = false;
+      any_alive = false;
+    }
+
+    if (!valid_utf8)
+      return fallback_rules.size() > 0;
+
+    string::const_iterator utf_iterator = characters.begin();
+    while (utf_iterator < characters.end())
+    {
+      unsigned int cp = utf8::next(utf_iterator, characters.end());
+
+      if (any_alive)
+      {
+        any_alive = false;
+        for (unsigned int i = 0; i < states.size(); i++)
+        {
+          GroupState& state = states[i];
+          if (!state.any_alive)
+            continue;
+
+          const CompiledPatterns::LengthGroup& group = patterns->groups[i];
+          if (position >= group.length)
+          {
+            state.any_alive = false;
+            continue;
+          }
+
+          const PatternMask& mask = getMask(i, position, cp);
+
+          state.any_alive = false;
+          for (int w = 0; w < group.words; w++)
+          {
+            state.alive[w] &= mask[w];
+            if (state.alive[w] != 0)
+              state.any_alive = true;
+          }
+
+          any_alive = any_alive || state.any_alive;
+        }
+      }
+
+      position++;
+    }
+
+    return any_alive || fallback_rules.size() > 0;
+  }
+
+  bool PatternMatcher::matches()
+  {
+    if (any_alive)
+    {
+      for (unsigned int i = 0; i < states.size(); i++)
+      {
+        if (states[i].any_alive && patterns->groups[i].length == position)
+          return true;
+      }
+    }
+
+    const vector<RegexRule*>& fallback_rules = patterns->fallback_rules;
+    for (unsigned int i = 0; i < fallback_rules.size(); i++)
+    {
+      if (fallback_rules[i]->match(candidate))
+        return true;
+    }
+
+    return false;
+  }
+
+  bool PatternMatcher::match(const std::string& text)
+  {
+    reset();
+    add(text);
+    return matches();
+  }
+
+  // The patterns in the group that accept the character at this position
+  const PatternMatcher::PatternMask& PatternMatcher::getMask(int group_index, int position, unsigned int cp)
+  {
+    const CompiledPatterns::LengthGroup& group = patterns->groups[group_index];
+    PositionMasks& masks = states[group_index].positions[position];
+
+    PatternMask* mask;
+    if (cp < (unsigned int) ASCII_CHARS)
+    {
+      mask = &masks.ascii[cp];
+      if (masks.ascii_known[cp])
+        return *mask;
+      masks.ascii_known[cp] = true;
+    }
+    else
+    {
+      map<unsigned int, PatternMask>::iterator existing = masks.other.find(cp);
+      if (existing != masks.other.end())
+        return existing->second;
+
+      mask = &masks.other[cp];
+      mask->resize(group.words, 0);
+    }
+
+    string character = utf8chr(cp);
+    for (unsigned int k = 0; k < group.pattern_regexes.size(); k++)
+    {
+      if (re2::RE2::FullMatch(character, *patterns->char_regexes[group.pattern_regexes[k][position]]))
+        (*mask)[k / BITS_PER_WORD] |= ((uint64_t) 1) << (k % BITS_PER_WORD);
+    }
+
+    return *mask;
+  }
+
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_PATTERNMATCHER_H
+#define OPENALPR_PATTERNMATCHER_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "regexrule.h"
+
+namespace alpr
+{
+
+  // All of a region's patterns, compiled for PatternMatcher.
+  //
+  // A pattern is a fixed sequence of single character regexes, so the patterns are grouped
+  // by length and each distinct character regex is compiled (with RE2) once.  Never modified
+  // after construction, so one copy is shared by every PatternMatcher for the region.
+  class CompiledPatterns
+  {
+    public:
+      // The rules must outlive the compiled patterns
+      CompiledPatterns(const std::vector<RegexRule*>& rules);
+      virtual ~CompiledPatterns();
+
+    private:
+      friend class PatternMatcher;
+
+      // All of the patterns with the same number of characters
+      struct LengthGroup
+      {
+        int length;
+        int words;
+
+        // Character regex (index into char_regexes) for each position of each pattern
+        std::vector<std::vector<int> > pattern_regexes;
+      };
+
+      std::vector<re2::RE2*> char_regexes;
+      std::map<std::string, int> char_regex_index;
+
+      std::vector<LengthGroup> groups;
+
+      // Rules that can't be split into single characters are matched the old way
+      std::vector<RegexRule*> fallback_rules;
+
+      int addCharRegex(const std::string& regex);
+  };
+
+  // Matches text against all of a region's patterns at once.
+  //
+  // Each length group tracks which of its patterns still match as characters arrive.
+  // Which patterns accept a character at a position is worked out the first time that
+  // character shows up there, and remembered.  After that each character costs a lookup
+  // and a bitwise AND, and a candidate can be abandoned as soon as no pattern is left.
+  //
+  // Not thread safe.  Each PostProcess has its own, on top of the shared CompiledPatterns.
+  class PatternMatcher
+  {
+    public:
+      // The patterns must outlive the matcher
+      PatternMatcher(const CompiledPatterns* patterns);
+      virtual ~PatternMatcher();
+
+      // Starts matching a new candidate
+      void reset();
+
+      // Adds the next character(s) of the candidate, UTF-8 encoded.
+      // Returns false once none of the patterns can match, no matter what follows
+      bool add(const std::string& characters);
+
+      // True if the characters added since reset() match one of the patterns
+      bool matches();
+
+      // Matches a whole string in one pass
+      bool match(const std::string& text);
+
+    private:
+
+      typedef std::vector<uint64_t> PatternMask;
+
+      struct PositionMasks
+      {
+        // ASCII characters are looked up directly.  Everything else goes through the map
+        std::vector<PatternMask> ascii;
+        std::vector<bool> ascii_known;
+        std::map<unsigned int, PatternMask> other;
+      };
+
+      // The matching state for one of the CompiledPatterns' length groups
+      struct GroupState
+      {
+        std::vector<PositionMasks> positions;
+
+        // Patterns that match the candidate so far
+        PatternMask alive;
+        bool any_alive;
+      };
+
+      const CompiledPatterns* patterns;
+
+      std::vector<GroupState> states;
+
+      std::string candidate;
+
+      int position;
+      bool valid_utf8;
+      bool any_alive;
+
+      const PatternMask& getMask(int group_index, int position, unsigned int cp);
+  };
+
+}
+
+#endif // OPENALPR_PATTERNMATCHER_H
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "permutationsearch.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace alpr
+{
+
+  PermutationSearch::PermutationSearch()
+  {
+    num_positions = 0;
+    results_remaining = 0;
+    states_used = 0;
+    max_states = 0;
+  }
+
+  PermutationSearch::~PermutationSearch()
+  {
+  }
+
+  void PermutationSearch::start(const std::vector<std::vector<float> >& position_scores, int max_results)
+  {
+    num_positions = position_scores.size();
+    results_remaining = max_results;
+
+    scores.clear();
+    score_offsets.resize(num_positions);
+    choice_counts.resize(num_positions);
+
+    float totalscore = 0;
+    for (int i = 0; i < num_positions; i++)
+    {
+      score_offsets[i] = scores.size();
+      choice_counts[i] = position_scores[i].size();
+      scores.insert(scores.end(), position_scores[i].begin(), position_scores[i].end());
+
+      if (position_scores[i].size() > 0)
+        totalscore += position_scores[i][0];
+    }
+
+    // Every result returned queues at most one child per position
+    max_states = 1 + max_results * num_positions;
+    if (states.size() < (unsigned int) (max_states * num_positions))
+      states.resize(max_states * num_positions);
+    heap.clear();
+    heap.reserve(max_states);
+
+    // Start with the best choice at every position
+    for (int i = 0; i < num_positions; i++)
+      states[i] = 0;
+    states_used = 1;
+
+    HeapEntry root;
+    root.score = totalscore;
+    root.state = 0;
+    root.first_position = 0;
+    heap.push_back(root);
+  }
+
+  bool PermutationSearch::next(std::vector<int>& choices, float* score)
+  {
+    if (results_remaining <= 0 || heap.size() == 0)
+      return false;
+
+    pop_heap(heap.begin(), heap.end(), heapCompare);
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    results_remaining--;
+
+    const unsigned short* state = &states[top.state * num_positions];
+
+    choices.resize(num_positions);
+    for (int i = 0; i < num_positions; i++)
+      choices[i] = state[i];
+    *score = top.score;
+
+    // No point queuing children that will never be requested
+    if (results_remaining == 0)
+      return true;
+
+    for (int i = top.first_position; i < num_positions; i++)
+    {
+      int choice = state[i];
+
+      // no more permutations with this letter
+      if (choice + 1 >= choice_counts[i])
+        continue;
+
+      unsigned short* child = &states[states_used * num_positions];
+      copy(state, state + num_positions, child);
+      child[i] = choice + 1;
+
+      HeapEntry entry;
+      entry.score = top.score - (scores[score_offsets[i] + choice] - scores[score_offsets[i] + choice + 1]);
+      entry.state = states_used;
+      entry.first_position = i;
+
+      states_used++;
+      heap.push_back(entry);
+      push_heap(heap.begin(), heap.end(), heapCompare);
+    }
+
+    return true;
+  }
+
+  bool PermutationSearch::heapCompare(const HeapEntry& a, const HeapEntry& b)
+  {
+    return a.score < b.score;
+  }
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_PERMUTATIONSEARCH_H
+#define OPENALPR_PERMUTATIONSEARCH_H
+
+#include <vector>
+
+namespace alpr
+{
+
+  // Enumerates the combinations of one choice per position from best to worst total score.
+  // Each position's choices must be sorted from best to worst.
+  //
+  // A combination's children each advance one position to its next choice, but only
+  // positions at or after the one its parent advanced.  That gives every combination
+  // exactly one parent, so no combination is ever queued twice and nothing needs to be
+  // remembered about the ones already visited.
+  //
+  // All storage is sized up front by start() and kept between searches, so a search
+  // doesn't allocate once the buffers have grown to fit.
+  class PermutationSearch
+  {
+    public:
+      PermutationSearch();
+      virtual ~PermutationSearch();
+
+      // Begins a new search.  position_scores holds each position's choice scores (best first).
+      // Positions without any choices are skipped.  max_results is the most combinations that
+      // will be requested with next().
+      void start(const std::vector<std::vector<float> >& position_scores, int max_results);
+
+      // Sets choices to the next best combination (an index into each position's scores)
+      // Returns false once every combination has been returned, or max_results is reached.
+      bool next(std::vector<int>& choices, float* score);
+
+    private:
+
+      struct HeapEntry
+      {
+        float score;
+        int state;
+
+        // The position this combination advanced from its parent.  Children only advance it or later ones
+        int first_position;
+      };
+
+      static bool heapCompare(const HeapEntry& a, const HeapEntry& b);
+
+      int num_positions;
+      int results_remaining;
+
+      // Scores for every position laid out end to end.  A position's scores start at score_offsets[i]
+      std::vector<float> scores;
+      std::vector<int> score_offsets;
+      std::vector<int> choice_counts;
+
+      // Choice indices for each queued combination, num_positions per combination
+      std::vector<unsigned short> states;
+      int states_used;
+      int max_states;
+
+      std::vector<HeapEntry> heap;
+  };
+
+}
+
+#endif // OPENALPR_PERMUTATIONSEARCH_H
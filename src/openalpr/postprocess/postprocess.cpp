@@ -19,8 +19,6 @@
 
 #include "postprocess.h"
 
-#include <fstream>
-#include <queue>
 #include <utility>
 
 using namespace std;
@@ -35,45 +33,16 @@ namespace alpr
     this->min_confidence = 0;
     this->skip_level = 0;
     
-    stringstream filename;
-    filename << config->getPostProcessRuntimeDir() << "/" << config->country << ".patterns";
-
-    std::ifstream infile(filename.str().c_str());
-
-    string region, pattern;
-    while (infile >> region >> pattern)
-    {
-      RegexRule* rule = new RegexRule(region, pattern, config->postProcessRegexLetters, config->postProcessRegexNumbers);
-      //cout << "REGION: " << region << " PATTERN: " << pattern << endl;
-
-      if (rules.find(region) == rules.end())
-      {
-        vector<RegexRule*> newRule;
-        newRule.push_back(rule);
-        rules[region] = newRule;
-      }
-      else
-      {
-        vector<RegexRule*> oldRule = rules[region];
-        oldRule.push_back(rule);
-        rules[region] = oldRule;
-      }
-    }
-
+    patterns = CountryPatterns::acquire(config);
   }
 
   PostProcess::~PostProcess()
   {
-    // TODO: Delete all entries in rules vector
-    map<string, vector<RegexRule*> >::iterator iter;
+    map<string, PatternMatcher*>::iterator matcher_iter;
+    for (matcher_iter = matchers.begin(); matcher_iter != matchers.end(); ++matcher_iter)
+      delete matcher_iter->second;
 
-    for (iter = rules.begin(); iter != rules.end(); ++iter)
-    {
-      for (int i = 0; i < iter->second.size(); i++)
-      {
-        delete iter->second[i];
-      }
-    }
+    CountryPatterns::release(patterns);
   }
   
   void PostProcess::setConfidenceThreshold(float min_confidence, float skip_level) {
@@ -81,6 +50,10 @@ namespace alpr
     this->skip_level = skip_level;
   }
 
+  void PostProcess::setConfig(Config* config) {
+    this->config = config;
+  }
+
 
   void PostProcess::addLetter(string letter, int line_index, int charposition, float score)
   {
@@ -261,7 +234,7 @@ namespace alpr
 
   bool PostProcess::regionIsValid(std::string templateregion)
   {
-    return rules.find(templateregion) != rules.end();
+    return patterns->getRules().find(templateregion) != patterns->getRules().end();
   }
   
   float PostProcess::calculateMaxConfidenceScore()
@@ -291,71 +264,52 @@ namespace alpr
     return this->allPossibilities;
   }
 
-  struct PermutationCompare {
-    bool operator() (pair<float,vector<int> > &a, pair<float,vector<int> > &b)
-    {
-      return (a.first < b.first);
-    }
-  };
-
   void PostProcess::findAllPermutations(string templateregion, int topn) {
 
-    // use a priority queue to process permutations in highest scoring order
-    priority_queue<pair<float,vector<int> >, vector<pair<float,vector<int> > >, PermutationCompare> permutations;
-    set<float> permutationHashes;
+    // Look up the region's patterns once, rather than for every permutation
+    PatternMatcher* matcher = NULL;
+    if (templateregion != "")
+      matcher = getMatcher(templateregion);
 
-    // push the first word onto the queue
-    float totalscore = 0;
-    for (int i=0; i<letters.size(); i++)
+    letterScores.resize(letters.size());
+    for (int i = 0; i < letters.size(); i++)
     {
-      if (letters[i].size() > 0)
-        totalscore += letters[i][0].totalscore;
+      letterScores[i].clear();
+      for (int j = 0; j < letters[i].size(); j++)
+        letterScores[i].push_back(letters[i][j].totalscore);
     }
-    vector<int> v(letters.size());
-    permutations.push(make_pair(totalscore, v));
 
+    // Every result either fills one of the topn slots or counts toward the 2*topn 
+    // consecutive misses allowed between them, which bounds how many are needed
+    permutationSearch.start(letterScores, max(1, 2 * topn * topn));
+
+    // process permutations in highest scoring order
     int consecutiveNonMatches = 0;
-    while (permutations.size() > 0)
+    float score;
+    while (permutationSearch.next(letterIndices, &score))
     {
-      // get the top permutation and analyze
-      pair<float, vector<int> > topPermutation = permutations.top();
-      if (analyzePermutation(topPermutation.second, templateregion, topn) == true)
+      if (analyzePermutation(letterIndices, matcher, templateregion != "") == true)
         consecutiveNonMatches = 0;
       else
         consecutiveNonMatches += 1;
-      permutations.pop();
 
       if (allPossibilities.size() >= topn || consecutiveNonMatches >= (topn*2))
         break;
-
-      // add child permutations to queue
-      for (int i=0; i<letters.size(); i++)
-      {
-        // no more permutations with this letter
-        if (topPermutation.second[i]+1 >= letters[i].size())
-          continue;
-
-        pair<float, vector<int> > childPermutation = topPermutation;
-        childPermutation.first -= letters[i][topPermutation.second[i]].totalscore - letters[i][topPermutation.second[i] + 1].totalscore;
-        childPermutation.second[i] += 1;
-
-        // ignore permutations that have already been visited (assume that score is a good hash for permutation)
-        if (permutationHashes.end() != permutationHashes.find(childPermutation.first))
-          continue;
-
-        permutations.push(childPermutation);
-        permutationHashes.insert(childPermutation.first);
-      }
     }
   }
 
-  bool PostProcess::analyzePermutation(vector<int> letterIndices, string templateregion, int topn)
+  bool PostProcess::analyzePermutation(const vector<int>& letterIndices, PatternMatcher* matcher, bool hasTemplate)
   {
-    PPResult possibility;
-    possibility.letters = "";
-    possibility.totalscore = 0;
-    possibility.matchesTemplate = false;
     int plate_char_length = 0;
+    float totalscore = 0;
+
+    // A candidate that must match a pattern can be dropped as soon as no pattern fits its first few letters
+    bool mustMatch = config->mustMatchPattern && hasTemplate;
+
+    // Build the candidate in a reused buffer.  Only accepted candidates are copied out
+    candidateLetters.clear();
+    if (matcher != NULL)
+      matcher->reset();
 
     int last_line = 0;
     for (int i = 0; i < letters.size(); i++)
@@ -363,22 +317,25 @@ namespace alpr
       if (letters[i].size() == 0)
         continue;
 
-      Letter letter = letters[i][letterIndices[i]];
+      const Letter& letter = letters[i][letterIndices[i]];
 
       // Add a "\n" on new lines
       if (letter.line_index != last_line)
       {
-        possibility.letters = possibility.letters + "\n";
+        candidateLetters += "\n";
+        if (matcher != NULL && !matcher->add("\n") && mustMatch)
+          return false;
       }
       last_line = letter.line_index;
       
       if (letter.letter != SKIP_CHAR)
       {
-        possibility.letters = possibility.letters + letter.letter;
-        possibility.letter_details.push_back(letter);
+        candidateLetters += letter.letter;
         plate_char_length += 1;
+        if (matcher != NULL && !matcher->add(letter.letter) && mustMatch)
+          return false;
       }
-      possibility.totalscore = possibility.totalscore + letter.totalscore;
+      totalscore = totalscore + letter.totalscore;
     }
 
     // ignore plates that don't fit the length requirements
@@ -386,30 +343,30 @@ namespace alpr
       plate_char_length > config->postProcessMaxCharacters)
       return false;
 
-    // Apply templates
-    if (templateregion != "")
-    {
-      vector<RegexRule*> regionRules = rules[templateregion];
-
-      for (int i = 0; i < regionRules.size(); i++)
-      {
-        possibility.matchesTemplate = regionRules[i]->match(possibility.letters);
-        if (possibility.matchesTemplate)
-        {
-          break;
-        }
-      }
-    }
-
     // ignore duplicate words
-    if (allPossibilitiesLetters.end() != allPossibilitiesLetters.find(possibility.letters))
+    if (allPossibilitiesLetters.end() != allPossibilitiesLetters.find(candidateLetters))
       return false;
 
+    // Apply templates
+    bool matchesTemplate = false;
+    if (matcher != NULL)
+      matchesTemplate = matcher->matches();
+
     // If mustMatchPattern is toggled in the config and a template is provided, 
     // only include this result if there is a pattern match
-    if (!config->mustMatchPattern || templateregion.size() == 0 || 
-        (config->mustMatchPattern && possibility.matchesTemplate))
+    if (!mustMatch || matchesTemplate)
     {
+      PPResult possibility;
+      possibility.letters = candidateLetters;
+      possibility.totalscore = totalscore;
+      possibility.matchesTemplate = matchesTemplate;
+
+      for (int i = 0; i < letters.size(); i++)
+      {
+        if (letters[i].size() > 0 && letters[i][letterIndices[i]].letter != SKIP_CHAR)
+          possibility.letter_details.push_back(letters[i][letterIndices[i]]);
+      }
+
       allPossibilities.push_back(possibility);
       allPossibilitiesLetters.insert(possibility.letters);
       return true;
@@ -420,13 +377,30 @@ namespace alpr
 
   std::vector<string> PostProcess::getPatterns() {
     vector<string> v;
-    for(map<string,std::vector<RegexRule*> >::iterator it = rules.begin(); it != rules.end(); ++it) {
+    const map<string, vector<RegexRule*> >& rules = patterns->getRules();
+    for(map<string,std::vector<RegexRule*> >::const_iterator it = rules.begin(); it != rules.end(); ++it) {
       v.push_back(it->first);
     }
     
     return v;
   }
 
+  // NULL if the region has no patterns
+  PatternMatcher* PostProcess::getMatcher(std::string region)
+  {
+    map<string, PatternMatcher*>::iterator it = matchers.find(region);
+    if (it != matchers.end())
+      return it->second;
+
+    const CompiledPatterns* compiled = patterns->getCompiledPatterns(region);
+    if (compiled == NULL)
+      return NULL;
+
+    PatternMatcher* matcher = new PatternMatcher(compiled);
+    matchers[region] = matcher;
+    return matcher;
+  }
+
   bool letterCompare( const Letter &left, const Letter &right )
   {
     if (left.totalscore < right.totalscore)
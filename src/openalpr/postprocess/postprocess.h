@@ -21,6 +21,9 @@
 #define OPENALPR_POSTPROCESS_H
 
 #include "regexrule.h"
+#include "patternmatcher.h"
+#include "countrypatterns.h"
+#include "permutationsearch.h"
 #include "constants.h"
 #include "utility.h"
 #include <set>
@@ -75,16 +78,24 @@ namespace alpr
       std::vector<std::string> getPatterns();
       
       void setConfidenceThreshold(float min_confidence, float skip_level);
+
+      void setConfig(Config* config);
       
     private:
       Config* config;
 
       void findAllPermutations(std::string templateregion, int topn);
-      bool analyzePermutation(std::vector<int> letterIndices, std::string templateregion, int topn);
+      bool analyzePermutation(const std::vector<int>& letterIndices, PatternMatcher* matcher, bool hasTemplate);
 
       void insertLetter(std::string letter, int line_index, int charPosition, float score);
 
-      std::map<std::string, std::vector<RegexRule*> > rules;
+      // Shared with every other PostProcess for the same country
+      CountryPatterns* patterns;
+
+      // Matching state for each region analyzed so far.  Created on first use
+      std::map<std::string, PatternMatcher*> matchers;
+
+      PatternMatcher* getMatcher(std::string region);
 
       float calculateMaxConfidenceScore();
 
@@ -94,6 +105,12 @@ namespace alpr
       std::vector<PPResult> allPossibilities;
       std::set<std::string> allPossibilitiesLetters;
       
+      // Reused by every analysis to avoid reallocating
+      PermutationSearch permutationSearch;
+      std::vector<std::vector<float> > letterScores;
+      std::vector<int> letterIndices;
+      std::string candidateLetters;
+      
       float min_confidence;
       float skip_level;
   };
@@ -24,8 +24,6 @@
 
 using namespace std;
 
-tthread::mutex regexrule_mutex_m;
-
 namespace alpr
 {
    
@@ -44,6 +42,7 @@ namespace alpr
     }
     
     std::stringstream regexval;
+    std::stringstream charregex;
     string::iterator utf_iterator = pattern.begin();
     numchars = 0;
     while (utf_iterator < pattern.end())
@@ -55,7 +54,7 @@ namespace alpr
       
       if (utf_character == "[")
       {
-        regexval << "[";
+        charregex << "[";
         
         while (utf_character != "]" )
         {
@@ -64,27 +63,27 @@ namespace alpr
           int cp = utf8::next(utf_iterator, pattern.end());
 
           utf_character = utf8chr(cp);
-          regexval << utf_character;
+          charregex << utf_character;
         }
         
       }
       else if (utf_character == "\\")
       {
         // Don't add "\" characters to our character count
-        regexval << utf_character;
+        charregex << utf_character;
         continue;
       }
       else if (utf_character == "?")
       {
-        regexval << ".";
+        charregex << ".";
       }
       else if (utf_character == "@")
       {
-        regexval << letters_regex;
+        charregex << letters_regex;
       }
       else if (utf_character == "#")
       {
-        regexval << numbers_regex;
+        charregex << numbers_regex;
       }
       else if ((utf_character == "*") || (utf_character == "+"))
       {
@@ -92,12 +91,19 @@ namespace alpr
       }
       else
       {
-        regexval << utf_character;
+        charregex << utf_character;
       }
 
+      regexval << charregex.str();
+      character_regexes.push_back(charregex.str());
+      charregex.str("");
+
       numchars++;
     }
 
+    // A trailing "\" still belongs in the regex (and makes it invalid)
+    regexval << charregex.str();
+
     this->regex = regexval.str();
 
     re2_regex = new re2::RE2(this->regex);
@@ -119,6 +125,16 @@ namespace alpr
     delete re2_regex;
   }
 
+  bool RegexRule::isValid()
+  {
+    return valid;
+  }
+
+  const std::vector<std::string>& RegexRule::getCharacterRegexes()
+  {
+    return character_regexes;
+  }
+
   bool RegexRule::match(string text)
   {
     if (!this->valid)
@@ -21,6 +21,7 @@
 #define	OPENALPR_REGEXRULE_H
 
 #include <string>
+#include <vector>
 
 #include "support/re2.h"
 #include "support/utf8.h"
@@ -36,10 +37,16 @@ namespace alpr
 
       bool match(std::string text);
 
+      bool isValid();
+
+      // The regex for each character of the pattern, in order.  Together they make up the full regex
+      const std::vector<std::string>& getCharacterRegexes();
+
     private:
       bool valid;
       
       int numchars;
+      std::vector<std::string> character_regexes;
       re2::RE2* re2_regex;
       std::string original;
       std::string regex;
@@ -25,14 +25,63 @@
 using namespace std;
 using namespace cv;
 
+tthread::mutex prewarp_cache_mutex_m;
+
 namespace alpr
 {
 
+  // Guarded by prewarp_cache_mutex_m
+  static map<string, PrewarpCache*> prewarp_caches;
+
+  // Each cached size for a 4K camera holds about 50MB of lookup maps
+  const unsigned int MAX_CACHED_FRAME_SIZES = 4;
+
+  // How much of each region of interest's size to also warp around it, with the remap_roi method
+  const float PREWARP_ROI_MARGIN = 0.1;
+
   PreWarp::PreWarp(Config* config)
   {
     this->config = config;
+    this->cache = NULL;
     initialize(config->prewarp);
   }
+
+  PreWarp::PreWarp(const PreWarp& other)
+  {
+    this->cache = NULL;
+    *this = other;
+  }
+
+  PreWarp& PreWarp::operator=(const PreWarp& other)
+  {
+    if (this == &other)
+      return *this;
+
+    this->config = other.config;
+    this->transform = other.transform;
+    this->valid = other.valid;
+    this->w = other.w;
+    this->h = other.h;
+    this->rotationx = other.rotationx;
+    this->rotationy = other.rotationy;
+    this->rotationz = other.rotationz;
+    this->panX = other.panX;
+    this->panY = other.panY;
+    this->stretchX = other.stretchX;
+    this->dist = other.dist;
+
+    if (this->cache != other.cache)
+    {
+      if (this->cache != NULL)
+        releaseCache(this->cache);
+
+      this->cache = NULL;
+      if (other.cache != NULL)
+        this->cache = acquireCache(other.cache->key);
+    }
+
+    return *this;
+  }
   
 
   void PreWarp::initialize(std::string prewarp_config) {
@@ -109,6 +158,8 @@ namespace alpr
   }
 
   PreWarp::~PreWarp() {
+    if (cache != NULL)
+      releaseCache(cache);
   }
   
   std::string PreWarp::toString() {
@@ -136,33 +187,205 @@ namespace alpr
     this->dist = dist;
     
     this->valid = true;
+
+    // Switch to the cache for the new settings.  The interpolation is part of the key since the
+    // maps are built differently for nearest neighbour
+    stringstream key;
+    key.precision(10);
+    key << w << "," << h << "," << rotationx << "," << rotationy << "," << rotationz << "," << panX << "," << panY << ","
+        << stretchX << "," << dist << "|" << config->prewarpMethod << "|" << config->prewarpInterpolation;
+
+    PrewarpCache* old_cache = cache;
+    cache = acquireCache(key.str());
+    if (old_cache != NULL)
+      releaseCache(old_cache);
+  }
+
+  // Returns the cache for the key, creating it if required.  Each acquire must be balanced by a release
+  PrewarpCache* PreWarp::acquireCache(std::string key)
+  {
+    tthread::lock_guard<tthread::mutex> guard(prewarp_cache_mutex_m);
+
+    PrewarpCache* cache;
+    map<string, PrewarpCache*>::iterator it = prewarp_caches.find(key);
+    if (it == prewarp_caches.end())
+    {
+      cache = new PrewarpCache();
+      cache->key = key;
+      cache->references = 0;
+      prewarp_caches[key] = cache;
+    }
+    else
+    {
+      cache = it->second;
+    }
+
+    cache->references++;
+    return cache;
+  }
+
+  void PreWarp::releaseCache(PrewarpCache* cache)
+  {
+    tthread::lock_guard<tthread::mutex> guard(prewarp_cache_mutex_m);
+
+    cache->references--;
+    if (cache->references == 0)
+    {
+      prewarp_caches.erase(cache->key);
+      delete cache;
+    }
+  }
+
+  PrewarpFrameCache PreWarp::getFrameCache(int cols, int rows, bool withMaps)
+  {
+    std::pair<int, int> key(cols, rows);
+    Mat frame_transform;
+
+    {
+      tthread::lock_guard<tthread::mutex> guard(cache->mutex);
+
+      if (cache->frames.find(key) == cache->frames.end())
+      {
+        if (cache->frames.size() >= MAX_CACHED_FRAME_SIZES)
+          cache->frames.clear();
+
+        float width_ratio = w / ((float)cols);
+        float height_ratio = h / ((float)rows);
+
+        float rx = rotationx * width_ratio;
+        float ry = rotationy * width_ratio;
+        float px = panX / width_ratio;
+        float py = panY / height_ratio;
+
+        PrewarpFrameCache frame;
+        frame.transform = getTransform(cols, rows, rx, ry, rotationz, px, py, stretchX, dist);
+        frame.uses = 0;
+        frame.building_maps = false;
+        cache->frames[key] = frame;
+      }
+
+      PrewarpFrameCache& frame = cache->frames[key];
+      frame.uses++;
+
+      if (!withMaps || frame.uses < 2 || !frame.map1.empty() || frame.building_maps)
+        return frame;
+
+      frame.building_maps = true;
+      frame_transform = frame.transform;
+    }
+
+    // Building the maps takes a while on large images.  Other threads keep warping without them
+    // rather than waiting on the lock
+    Mat transform64;
+    frame_transform.convertTo(transform64, CV_64F);
+    const double* M = transform64.ptr<double>(0);
+
+    // The transform maps each warped pixel back to where it comes from in the original image
+    Mat map_x(rows, cols, CV_32F);
+    Mat map_y(rows, cols, CV_32F);
+    for (int y = 0; y < rows; y++)
+    {
+      float* map_x_row = map_x.ptr<float>(y);
+      float* map_y_row = map_y.ptr<float>(y);
+      for (int x = 0; x < cols; x++)
+      {
+        double X = M[0] * x + M[1] * y + M[2];
+        double Y = M[3] * x + M[4] * y + M[5];
+        double W = M[6] * x + M[7] * y + M[8];
+        W = W ? 1.0 / W : 0;
+
+        map_x_row[x] = X * W;
+        map_y_row[x] = Y * W;
+      }
+    }
+
+    Mat map1, map2;
+    convertMaps(map_x, map_y, map1, map2, CV_16SC2, config->prewarpInterpolation == PREWARP_NEAREST);
+
+    tthread::lock_guard<tthread::mutex> guard(cache->mutex);
+
+    // The size may have been dropped from the cache meanwhile.  Put it back with the maps
+    if (cache->frames.find(key) == cache->frames.end())
+    {
+      if (cache->frames.size() >= MAX_CACHED_FRAME_SIZES)
+        cache->frames.clear();
+
+      PrewarpFrameCache frame;
+      frame.transform = frame_transform;
+      frame.uses = 1;
+      cache->frames[key] = frame;
+    }
+
+    PrewarpFrameCache& frame = cache->frames[key];
+    frame.map1 = map1;
+    frame.map2 = map2;
+    frame.building_maps = false;
+
+    return frame;
   }
   
   cv::Mat PreWarp::warpImage(Mat image) {
+    return warpImage(image, vector<Rect>());
+  }
+
+  cv::Mat PreWarp::warpImage(Mat image, const vector<Rect>& regionsOfInterest) {
     if (!this->valid)
     {
       if (this->config->debugPrewarp)
         cout << "prewarp skipped due to missing prewarp config" << endl;
       return image;
     }
-    
-      
-    float width_ratio = w / ((float)image.cols);
-    float height_ratio = h / ((float)image.rows);
 
-    float rx = rotationx * width_ratio;
-    float ry = rotationy * width_ratio;
-    float px = panX / width_ratio;
-    float py = panY / height_ratio;
+    timespec startTime;
+    getTimeMonotonic(&startTime);
 
+    int method = config->prewarpMethod;
+    PrewarpFrameCache frame = getFrameCache(image.cols, image.rows, method != PREWARP_PERSPECTIVE);
+    transform = frame.transform;
 
-    transform = getTransform(image.cols, image.rows, rx, ry, rotationz, px, py, stretchX, dist);
-    
+    int interpolation = INTER_CUBIC;
+    if (config->prewarpInterpolation == PREWARP_NEAREST)
+      interpolation = INTER_NEAREST;
+    else if (config->prewarpInterpolation == PREWARP_LINEAR)
+      interpolation = INTER_LINEAR;
     
     Mat warped_image;
   
-    warpPerspective(image, warped_image, transform, image.size(), INTER_CUBIC | WARP_INVERSE_MAP);
+    if (frame.map1.empty())
+    {
+      warpPerspective(image, warped_image, transform, image.size(), interpolation | WARP_INVERSE_MAP);
+    }
+    else if (method == PREWARP_REMAP || regionsOfInterest.size() == 0)
+    {
+      remap(image, warped_image, frame.map1, frame.map2, interpolation);
+    }
+    else
+    {
+      warped_image = Mat::zeros(image.size(), image.type());
+
+      vector<Rect> warpedRegions = projectRects(regionsOfInterest, image.cols, image.rows, false);
+      for (unsigned int i = 0; i < warpedRegions.size(); i++)
+      {
+        Rect region = expandRect(warpedRegions[i], warpedRegions[i].width * PREWARP_ROI_MARGIN,
+                                 warpedRegions[i].height * PREWARP_ROI_MARGIN, image.cols, image.rows);
+        if (region.area() == 0)
+          continue;
+
+        Mat warped_region = warped_image(region);
+        Mat map2_region;
+        if (!frame.map2.empty())
+          map2_region = frame.map2(region);
+
+        remap(image, warped_region, frame.map1(region), map2_region, interpolation);
+      }
+    }
 
+    if (config->debugTiming)
+    {
+      timespec endTime;
+      getTimeMonotonic(&endTime);
+      cout << "Prewarp Time: " << diffclock(startTime, endTime) << "ms." << endl;
+    }
     
     if (this->config->debugPrewarp && this->config->debugShowImages)
     {
@@ -21,23 +21,61 @@
 #ifndef OPENALPR_PREWARP_H
 #define	OPENALPR_PREWARP_H
 
+#include <map>
+
 #include "config.h"
 #include "utility.h"
 #include "opencv2/imgproc/imgproc.hpp"
 #include "detection/detector_types.h"
+#include "support/tinythread.h"
 
 namespace alpr
 {
 
+  // What the warp for one image size needs.  Built on first use
+  struct PrewarpFrameCache
+  {
+    cv::Mat transform;
+
+    // Fixed-point lookup maps, for the remap methods.  Only built once the size is seen a second
+    // time, so that a PreWarp used for a single image doesn't pay for them
+    cv::Mat map1;
+    cv::Mat map2;
+    int uses;
+
+    // One thread builds the maps (outside the cache's lock).  The others warp without them meanwhile
+    bool building_maps;
+  };
+
+  // Shared by every PreWarp in the process with the same settings (including the copies made
+  // for each image), so that each image size's transform and maps are only computed and held once.
+  // Reference counted, like ModelBundle
+  struct PrewarpCache
+  {
+    std::string key;
+    int references;
+
+    tthread::mutex mutex;
+    std::map<std::pair<int, int>, PrewarpFrameCache> frames;
+  };
+
   class PreWarp {
   public:
     PreWarp(Config* config);
+
+    // Copies share the original's cache
+    PreWarp(const PreWarp& other);
+    PreWarp& operator=(const PreWarp& other);
     virtual ~PreWarp();
 
     void initialize(std::string prewarp_config);
     void clear();
     
     cv::Mat warpImage(cv::Mat image);
+
+    // With the remap_roi method, only the parts of the image around the (unwarped) regions of interest
+    // are warped.  Otherwise the same as warpImage(image)
+    cv::Mat warpImage(cv::Mat image, const std::vector<cv::Rect>& regionsOfInterest);
     std::vector<cv::Point2f> projectPoints(std::vector<cv::Point2f> points, bool inverse);
     std::vector<cv::Rect> projectRects(std::vector<cv::Rect> rects, int maxWidth, int maxHeight, bool inverse);
     cv::Rect projectRect(cv::Rect rect, int maxWidth, int maxHeight, bool inverse);
@@ -54,6 +92,14 @@ namespace alpr
     cv::Mat transform;
     
     cv::Mat getTransform(float w, float h, float rotationx, float rotationy, float rotationz, float panX, float panY, float stretchX, float dist);
+
+    // NULL until a transform is set
+    PrewarpCache* cache;
+
+    static PrewarpCache* acquireCache(std::string key);
+    static void releaseCache(PrewarpCache* cache);
+
+    PrewarpFrameCache getFrameCache(int cols, int rows, bool withMaps);
     
     float w, h, rotationx, rotationy, rotationz, stretchX, dist, panX, panY;
     
@@ -29,14 +29,12 @@ namespace alpr
 
   ResultAggregator::ResultAggregator(ResultMergeStrategy merge_strategy, int topn, Config* config)
   {
-    this->prewarp = new PreWarp(config);
     this->merge_strategy = merge_strategy;
     this->topn = topn;
     this->config = config;
   }
 
   ResultAggregator::~ResultAggregator() {
-    delete prewarp;
   }
 
 
@@ -74,10 +72,11 @@ namespace alpr
     
     //cout << "Iteration: " << index << ": " << x_rotation << ", " << y_rotation << ", " << z_rotation << endl;
     
-    prewarp->setTransform(WIDTH_HEIGHT, WIDTH_HEIGHT, x_rotation, y_rotation, z_rotation, 
+    PreWarp prewarp(config);
+    prewarp.setTransform(WIDTH_HEIGHT, WIDTH_HEIGHT, x_rotation, y_rotation, z_rotation, 
             NO_PAN_VAL, NO_PAN_VAL, NO_MOVE_WIDTH_DIST, NO_MOVE_WIDTH_DIST);
     
-    return prewarp->warpImage(image);
+    return prewarp.warpImage(image);
   }
 
   bool compareScore(const std::pair<float, ResultPlateScore>& firstElem, const std::pair<float, ResultPlateScore>& secondElem) {
@@ -137,125 +136,128 @@ namespace alpr
     {
       // Each cluster is the same plate, just analyzed from a slightly different 
       // perspective.  Merge them together and score them as if they are one
+      for (unsigned int unique_plate_idx = 0; unique_plate_idx < clusters.size(); unique_plate_idx++)
+      {
+        AlprPlateResult combined;
+        if (combinePlates(clusters[unique_plate_idx], &combined))
+          response.results.plates.push_back(combined);
+      }
+    }
 
-      const float MIN_CONFIDENCE = 75;
-      
+    return response;
+  }
+  
+  bool ResultAggregator::combinePlates(const std::vector<AlprPlateResult>& cluster, AlprPlateResult* combined)
+  {
+    const float MIN_CONFIDENCE = 75;
 
-      // Factor in the position of the plate in the topN list, the confidence, and the template match status
-      // First loop is for clusters of possible plates.  If they're in separate clusters, they don't get combined, 
-      // since they are likely separate plates in the same image
-      for (unsigned int unique_plate_idx = 0; unique_plate_idx < clusters.size(); unique_plate_idx++)
+    // Factor in the position of the plate in the topN list, the confidence, and the template match status
+    std::map<string, ResultPlateScore> score_hash;
+
+    // First loop is for separate plate results for the same plate
+    for (unsigned int i = 0; i < cluster.size(); i++)
+    {
+      // Second loop is the individual topN results for a single plate result
+      for (unsigned int j = 0; j < cluster[i].topNPlates.size() && j < topn; j++)
       {
-        std::map<string, ResultPlateScore> score_hash;
-        
-        // Second loop is for separate plate results for the same plate
-        for (unsigned int i = 0; i < clusters[unique_plate_idx].size(); i++)
+        AlprPlate plateCandidate = cluster[i].topNPlates[j];
+
+        if (plateCandidate.overall_confidence < MIN_CONFIDENCE)
+          continue;
+
+        float score = (plateCandidate.overall_confidence - 60) * 4;
+
+        // Add a bonus for matching the template
+        if (plateCandidate.matches_template)
+          score += 150;
+
+        // Add a bonus the higher the plate is to the #1 position
+        // and how frequently it appears there
+        float position_score_max_bonus = 65;
+        float frequency_modifier = ((float) position_score_max_bonus) / topn;
+        score += position_score_max_bonus - (j * frequency_modifier);
+
+
+        if (score_hash.find(plateCandidate.characters) == score_hash.end())
         {
-          // Third loop is the individual topN results for a single plate result
-          for (unsigned int j = 0; j < clusters[unique_plate_idx][i].topNPlates.size() && j < topn; j++)
-          {
-            AlprPlate plateCandidate = clusters[unique_plate_idx][i].topNPlates[j];
-            
-            if (plateCandidate.overall_confidence < MIN_CONFIDENCE)
-              continue;
-
-            float score = (plateCandidate.overall_confidence - 60) * 4;
-
-            // Add a bonus for matching the template
-            if (plateCandidate.matches_template)
-              score += 150;
-
-            // Add a bonus the higher the plate is to the #1 position
-            // and how frequently it appears there
-            float position_score_max_bonus = 65;
-            float frequency_modifier = ((float) position_score_max_bonus) / topn;
-            score += position_score_max_bonus - (j * frequency_modifier);
-            
-
-            if (score_hash.find(plateCandidate.characters) == score_hash.end())
-            {
-              ResultPlateScore newentry;
-              newentry.plate = plateCandidate;
-              newentry.score_total = 0;
-              newentry.count = 0;
-              score_hash[plateCandidate.characters] = newentry;
-            }
-
-            score_hash[plateCandidate.characters].score_total += score;
-            score_hash[plateCandidate.characters].count += 1;
-            // Use the best confidence value for a particular candidate
-            if (plateCandidate.overall_confidence > score_hash[plateCandidate.characters].plate.overall_confidence)
-              score_hash[plateCandidate.characters].plate.overall_confidence = plateCandidate.overall_confidence;
-          }
+          ResultPlateScore newentry;
+          newentry.plate = plateCandidate;
+          newentry.score_total = 0;
+          newentry.count = 0;
+          score_hash[plateCandidate.characters] = newentry;
         }
 
-        // There is a big list of results that have scores.  Sort them by top score
-        std::vector<std::pair<float, ResultPlateScore> > sorted_results;
-        std::map<string, ResultPlateScore>::iterator iter;
-        for (iter = score_hash.begin(); iter != score_hash.end(); iter++) {
-          std::pair<float,ResultPlateScore> r;
-          r.second = iter->second;
-          r.first = iter->second.score_total;
-          sorted_results.push_back(r);
-        }
+        score_hash[plateCandidate.characters].score_total += score;
+        score_hash[plateCandidate.characters].count += 1;
+        // Use the best confidence value for a particular candidate
+        if (plateCandidate.overall_confidence > score_hash[plateCandidate.characters].plate.overall_confidence)
+          score_hash[plateCandidate.characters].plate.overall_confidence = plateCandidate.overall_confidence;
+      }
+    }
 
-        std::sort(sorted_results.begin(), sorted_results.end(), compareScore);
-        
-        // output the sorted list for debugging:
-        if (config->debugGeneral)
-        {
-          cout << "Result Aggregator Scores: " << endl;
-          cout << "  " << std::setw(14) << "Plate Num"
-              << std::setw(15) << "Score"
-              << std::setw(10) << "Count"
-              << std::setw(10) << "Best conf (%)"
-              << endl;
-          
-          for (int r_idx = 0; r_idx < sorted_results.size(); r_idx++)
-          {
-            cout << "  " << std::setw(14) << sorted_results[r_idx].second.plate.characters
-                    << std::setw(15) << sorted_results[r_idx].second.score_total
-                    << std::setw(10) << sorted_results[r_idx].second.count
-                    << std::setw(10) << sorted_results[r_idx].second.plate.overall_confidence 
-                    << endl;
+    // There is a big list of results that have scores.  Sort them by top score
+    std::vector<std::pair<float, ResultPlateScore> > sorted_results;
+    std::map<string, ResultPlateScore>::iterator iter;
+    for (iter = score_hash.begin(); iter != score_hash.end(); iter++) {
+      std::pair<float,ResultPlateScore> r;
+      r.second = iter->second;
+      r.first = iter->second.score_total;
+      sorted_results.push_back(r);
+    }
 
-          }
-        }
-        
-        if (sorted_results.size() > 0)
-        {
-          // Figure out the best region for this cluster
-          ResultRegionScore regionResults = findBestRegion(clusters[unique_plate_idx]);
-
-          AlprPlateResult firstResult = clusters[unique_plate_idx][0];
-          AlprPlateResult copyResult;
-          copyResult.bestPlate = sorted_results[0].second.plate;
-          copyResult.plate_index = firstResult.plate_index;
-          copyResult.region = regionResults.region;
-          copyResult.regionConfidence = regionResults.confidence;
-          copyResult.processing_time_ms = firstResult.processing_time_ms;
-          copyResult.requested_topn = firstResult.requested_topn;
-          for (int p_idx = 0; p_idx < 4; p_idx++)
-            copyResult.plate_points[p_idx] = firstResult.plate_points[p_idx];
-
-          for (int i = 0; i < sorted_results.size(); i++)
-          {
-            if (i >= topn)
-              break;
+    std::sort(sorted_results.begin(), sorted_results.end(), compareScore);
 
-            copyResult.topNPlates.push_back(sorted_results[i].second.plate);
-          }
-          
-          response.results.plates.push_back(copyResult);
-        }
+    // output the sorted list for debugging:
+    if (config->debugGeneral)
+    {
+      cout << "Result Aggregator Scores: " << endl;
+      cout << "  " << std::setw(14) << "Plate Num"
+          << std::setw(15) << "Score"
+          << std::setw(10) << "Count"
+          << std::setw(10) << "Best conf (%)"
+          << endl;
+
+      for (int r_idx = 0; r_idx < sorted_results.size(); r_idx++)
+      {
+        cout << "  " << std::setw(14) << sorted_results[r_idx].second.plate.characters
+                << std::setw(15) << sorted_results[r_idx].second.score_total
+                << std::setw(10) << sorted_results[r_idx].second.count
+                << std::setw(10) << sorted_results[r_idx].second.plate.overall_confidence 
+                << endl;
 
       }
     }
 
-    return response;
+    if (sorted_results.size() == 0)
+      return false;
+
+    // Figure out the best region for this cluster
+    ResultRegionScore regionResults = findBestRegion(cluster);
+
+    AlprPlateResult firstResult = cluster[0];
+    AlprPlateResult copyResult;
+    copyResult.bestPlate = sorted_results[0].second.plate;
+    copyResult.plate_index = firstResult.plate_index;
+    copyResult.region = regionResults.region;
+    copyResult.regionConfidence = regionResults.confidence;
+    copyResult.processing_time_ms = firstResult.processing_time_ms;
+    copyResult.requested_topn = firstResult.requested_topn;
+    for (int p_idx = 0; p_idx < 4; p_idx++)
+      copyResult.plate_points[p_idx] = firstResult.plate_points[p_idx];
+
+    for (int i = 0; i < sorted_results.size(); i++)
+    {
+      if (i >= topn)
+        break;
+
+      copyResult.topNPlates.push_back(sorted_results[i].second.plate);
+    }
+
+    *combined = copyResult;
+    return true;
   }
-  
-  ResultRegionScore ResultAggregator::findBestRegion(std::vector<AlprPlateResult> cluster) {
+
+  ResultRegionScore ResultAggregator::findBestRegion(const std::vector<AlprPlateResult>& cluster) {
 
     const float MIN_REGION_CONFIDENCE = 60;
     
@@ -366,35 +368,11 @@ namespace alpr
   int ResultAggregator::overlaps(AlprPlateResult plate,
                                  std::vector<std::vector<AlprPlateResult> > clusters)
   {
-    // Check the center positions to see how close they are to each other
-    // Also compare the size.  If it's much much larger/smaller, treat it as a separate cluster
-
-    PlateShapeInfo psi = getShapeInfo(plate);
-
     for (unsigned int i = 0; i < clusters.size(); i++)
     {
       for (unsigned int k = 0; k < clusters[i].size(); k++)
       {
-        PlateShapeInfo cluster_shapeinfo = getShapeInfo(clusters[i][k]);
-
-        int diffx = abs(psi.center.x - cluster_shapeinfo.center.x);
-        int diffy = abs(psi.center.y - cluster_shapeinfo.center.y);
-
-        // divide the larger plate area by the smaller plate area to determine a match
-        float area_diff;
-        if (psi.area > cluster_shapeinfo.area)
-          area_diff = psi.area / cluster_shapeinfo.area;
-        else
-          area_diff = cluster_shapeinfo.area / psi.area;
-
-        int max_x_diff = (psi.max_width + cluster_shapeinfo.max_width) / 2;
-        int max_y_diff = (psi.max_height + cluster_shapeinfo.max_height) / 2;
-
-        float max_area_diff = 4.0;
-        // Consider it a match if center diffx/diffy are less than the average height
-        // the area is not more than 4x different
-
-        if (diffx <= max_x_diff && diffy <= max_y_diff && area_diff <= max_area_diff)
+        if (platesOverlap(plate, clusters[i][k]))
         {
           return i;
         }
@@ -405,4 +383,30 @@ namespace alpr
 
     return -1;
   }
-}
\ No newline at end of file
+
+  bool ResultAggregator::platesOverlap(AlprPlateResult plate1, AlprPlateResult plate2)
+  {
+    // Check the center positions to see how close they are to each other
+    // Also compare the size.  If it's much much larger/smaller, treat it as a separate cluster
+    PlateShapeInfo psi = getShapeInfo(plate1);
+    PlateShapeInfo cluster_shapeinfo = getShapeInfo(plate2);
+
+    int diffx = abs(psi.center.x - cluster_shapeinfo.center.x);
+    int diffy = abs(psi.center.y - cluster_shapeinfo.center.y);
+
+    // divide the larger plate area by the smaller plate area to determine a match
+    float area_diff;
+    if (psi.area > cluster_shapeinfo.area)
+      area_diff = psi.area / cluster_shapeinfo.area;
+    else
+      area_diff = cluster_shapeinfo.area / psi.area;
+
+    int max_x_diff = (psi.max_width + cluster_shapeinfo.max_width) / 2;
+    int max_y_diff = (psi.max_height + cluster_shapeinfo.max_height) / 2;
+
+    float max_area_diff = 4.0;
+    // Consider it a match if center diffx/diffy are less than the average height
+    // the area is not more than 4x different
+    return (diffx <= max_x_diff && diffy <= max_y_diff && area_diff <= max_area_diff);
+  }
+}
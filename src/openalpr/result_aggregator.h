@@ -68,21 +68,28 @@ namespace alpr
 
     AlprFullDetails getAggregateResults();
 
+    // Safe to call from several threads at once
     cv::Mat applyImperceptibleChange(cv::Mat image, int index);
     
+    // Merges several readings of the same plate into one by voting across their topN lists.
+    // Returns false if none of the readings has a candidate confident enough to report
+    bool combinePlates(const std::vector<AlprPlateResult>& cluster, AlprPlateResult* combined);
+
+    static PlateShapeInfo getShapeInfo(AlprPlateResult plate);
+    
+    // True if the plates are close enough in position and size to be the same plate
+    static bool platesOverlap(AlprPlateResult plate1, AlprPlateResult plate2);
+    
   private:
     
     int topn;
-    PreWarp* prewarp;
     Config* config;
     
     std::vector<AlprFullDetails> all_results;
 
-    PlateShapeInfo getShapeInfo(AlprPlateResult plate);
-
     ResultMergeStrategy merge_strategy;
     
-    ResultRegionScore findBestRegion(std::vector<AlprPlateResult> cluster);
+    ResultRegionScore findBestRegion(const std::vector<AlprPlateResult>& cluster);
     
     std::vector<std::vector<AlprPlateResult> > findClusters();
     int overlaps(AlprPlateResult plate, std::vector<std::vector<AlprPlateResult> > clusters);
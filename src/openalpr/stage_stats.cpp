@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stage_stats.h"
+
+using namespace std;
+
+namespace alpr
+{
+
+  // Upper bound (in ms) of each histogram bucket.  Anything slower lands in one last bucket
+  const double STAGE_HISTOGRAM_BOUNDS_MS[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000 };
+  const int NUM_STAGE_HISTOGRAM_BOUNDS = sizeof(STAGE_HISTOGRAM_BOUNDS_MS) / sizeof(STAGE_HISTOGRAM_BOUNDS_MS[0]);
+
+  // The stages that can reject a plate region, in the order they run
+  const char* REJECTION_STAGES[] = { "prefilter_contrast", "prefilter_variance", "prefilter_edges",
+                                     "character_analysis", "plate_corners", "ocr", "other" };
+  const int NUM_REJECTION_STAGES = sizeof(REJECTION_STAGES) / sizeof(REJECTION_STAGES[0]);
+
+  const char* getStageName(ALPR_STAGE stage)
+  {
+    switch (stage)
+    {
+      case STAGE_DETECT:
+        return "detect";
+      case STAGE_THRESHOLDS:
+        return "thresholds";
+      case STAGE_CONTOURS:
+        return "contours";
+      case STAGE_EDGES:
+        return "edges";
+      case STAGE_DESKEW:
+        return "deskew";
+      case STAGE_SEGMENT:
+        return "segment";
+      case STAGE_OCR:
+        return "ocr";
+      case STAGE_POSTPROCESS:
+        return "postprocess";
+      default:
+        return "unknown";
+    }
+  }
+
+  StageStats::StageStats()
+  {
+    for (int i = 0; i < NUM_ALPR_STAGES; i++)
+    {
+      stages[i].count = 0;
+      stages[i].total_ms = 0;
+      stages[i].max_ms = 0;
+      stages[i].buckets.resize(NUM_STAGE_HISTOGRAM_BOUNDS + 1, 0);
+    }
+  }
+
+  StageStats::~StageStats()
+  {
+  }
+
+  void StageStats::addTime(ALPR_STAGE stage, double time_ms)
+  {
+    int bucket = 0;
+    while (bucket < NUM_STAGE_HISTOGRAM_BOUNDS && time_ms > STAGE_HISTOGRAM_BOUNDS_MS[bucket])
+      bucket++;
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    StageHistogram& histogram = stages[stage];
+    histogram.count++;
+    histogram.total_ms += time_ms;
+    if (time_ms > histogram.max_ms)
+      histogram.max_ms = time_ms;
+    histogram.buckets[bucket]++;
+  }
+
+  void StageStats::addCount(std::string counter, int64_t count)
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    counters[counter] += count;
+  }
+
+  void StageStats::addRejection(std::string stage)
+  {
+    if (stage.length() == 0)
+      stage = "other";
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    rejections[stage]++;
+  }
+
+  AlprStats StageStats::getStats()
+  {
+    AlprStats stats;
+    stats.histogram_bounds_ms.assign(STAGE_HISTOGRAM_BOUNDS_MS, STAGE_HISTOGRAM_BOUNDS_MS + NUM_STAGE_HISTOGRAM_BOUNDS);
+
+    // Copies the rejections under their own lock
+    stats.rejections = getRejectionCounts();
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    for (int i = 0; i < NUM_ALPR_STAGES; i++)
+    {
+      AlprStageHistogram histogram;
+      histogram.stage = getStageName((ALPR_STAGE) i);
+      histogram.count = stages[i].count;
+      histogram.total_ms = stages[i].total_ms;
+      histogram.max_ms = stages[i].max_ms;
+      histogram.buckets = stages[i].buckets;
+      stats.stages.push_back(histogram);
+    }
+
+    for (map<string, int64_t>::iterator it = counters.begin(); it != counters.end(); it++)
+    {
+      AlprCounter counter;
+      counter.name = it->first;
+      counter.value = it->second;
+      stats.counters.push_back(counter);
+    }
+
+    return stats;
+  }
+
+  std::vector<AlprStageCount> StageStats::getRejectionCounts()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    std::vector<AlprStageCount> counts;
+    for (int i = 0; i < NUM_REJECTION_STAGES; i++)
+    {
+      AlprStageCount count;
+      count.stage = REJECTION_STAGES[i];
+      count.rejected = 0;
+
+      map<string, int64_t>::iterator existing = rejections.find(REJECTION_STAGES[i]);
+      if (existing != rejections.end())
+        count.rejected = existing->second;
+      counts.push_back(count);
+    }
+
+    return counts;
+  }
+
+  StageTimes::StageTimes(StageStats* totals)
+  {
+    this->totals = totals;
+
+    for (int i = 0; i < NUM_ALPR_STAGES; i++)
+    {
+      times[i] = 0;
+      ran[i] = false;
+    }
+  }
+
+  StageTimes::~StageTimes()
+  {
+  }
+
+  void StageTimes::addTime(ALPR_STAGE stage, double time_ms)
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(mMutex);
+      times[stage] += time_ms;
+      ran[stage] = true;
+    }
+
+    if (totals != NULL)
+      totals->addTime(stage, time_ms);
+  }
+
+  double StageTimes::addTimeSince(ALPR_STAGE stage, timespec startTime)
+  {
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    double time_ms = diffclock(startTime, endTime);
+
+    addTime(stage, time_ms);
+    return time_ms;
+  }
+
+  void StageTimes::addCount(std::string counter, int64_t count)
+  {
+    if (totals != NULL)
+      totals->addCount(counter, count);
+  }
+
+  std::vector<AlprStageTime> StageTimes::getTimes()
+  {
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    std::vector<AlprStageTime> stage_times;
+    for (int i = 0; i < NUM_ALPR_STAGES; i++)
+    {
+      if (!ran[i])
+        continue;
+
+      AlprStageTime stage_time;
+      stage_time.stage = getStageName((ALPR_STAGE) i);
+      stage_time.time_ms = times[i];
+      stage_times.push_back(stage_time);
+    }
+
+    return stage_times;
+  }
+
+}
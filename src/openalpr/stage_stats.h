@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_STAGESTATS_H
+#define OPENALPR_STAGESTATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "alpr.h"
+#include "support/timing.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // The timed stages of the pipeline, in the order they run
+  enum ALPR_STAGE
+  {
+    STAGE_DETECT,
+    STAGE_THRESHOLDS,
+    STAGE_CONTOURS,
+    STAGE_EDGES,
+    STAGE_DESKEW,
+    STAGE_SEGMENT,
+    STAGE_OCR,
+    STAGE_POSTPROCESS,
+    NUM_ALPR_STAGES
+  };
+
+  const char* getStageName(ALPR_STAGE stage);
+
+  // Histograms of the time spent in each stage, and counts of the plate regions analyzed and
+  // rejected, across every image an Alpr instance has processed.  Thread safe.
+  class StageStats
+  {
+    public:
+      StageStats();
+      virtual ~StageStats();
+
+      void addTime(ALPR_STAGE stage, double time_ms);
+
+      void addCount(std::string counter, int64_t count = 1);
+
+      // stage is the disqualify_stage of the plate region (e.g., "character_analysis")
+      void addRejection(std::string stage);
+
+      AlprStats getStats();
+      std::vector<AlprStageCount> getRejectionCounts();
+
+    private:
+      tthread::mutex mMutex;
+
+      struct StageHistogram
+      {
+        int64_t count;
+        double total_ms;
+        double max_ms;
+        std::vector<int64_t> buckets;
+      };
+
+      StageHistogram stages[NUM_ALPR_STAGES];
+
+      std::map<std::string, int64_t> counters;
+      std::map<std::string, int64_t> rejections;
+  };
+
+  // The time spent in each stage while processing one image.  Every time added is also added
+  // to the instance-wide histograms.  Thread safe, since an image's plates may be analyzed in parallel.
+  class StageTimes
+  {
+    public:
+      StageTimes(StageStats* totals);
+      virtual ~StageTimes();
+
+      void addTime(ALPR_STAGE stage, double time_ms);
+
+      // Adds the time since startTime.  Returns the elapsed time in ms
+      double addTimeSince(ALPR_STAGE stage, timespec startTime);
+
+      // Adds to one of the instance-wide counters
+      void addCount(std::string counter, int64_t count = 1);
+
+      // The stages that ran, with their summed times
+      std::vector<AlprStageTime> getTimes();
+
+    private:
+      tthread::mutex mMutex;
+      StageStats* totals;
+
+      double times[NUM_ALPR_STAGES];
+      bool ran[NUM_ALPR_STAGES];
+  };
+
+}
+
+#endif // OPENALPR_STAGESTATS_H
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "threadpool.h"
+
+#include <stdexcept>
+
+namespace alpr
+{
+
+  ThreadPool::ThreadPool(unsigned int num_threads)
+  {
+    active = true;
+
+    for (unsigned int i = 0; i < num_threads; i++)
+      workers.push_back(new tthread::thread(ThreadPool::workerThread, (void*) this));
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    mMutex.lock();
+    active = false;
+    taskAvailable.notify_all();
+    mMutex.unlock();
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+    {
+      workers[i]->join();
+      delete workers[i];
+    }
+  }
+
+  void ThreadPool::enqueue(ThreadPoolTask task, void* arg, TaskGroup* group)
+  {
+    QueuedTask queued;
+    queued.func = task;
+    queued.arg = arg;
+    queued.group = group;
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+    if (group != NULL)
+      group->pending++;
+
+    tasks.push_back(queued);
+    taskAvailable.notify_one();
+  }
+
+  void ThreadPool::wait(TaskGroup* group)
+  {
+    mMutex.lock();
+    while (group->pending > 0)
+    {
+      if (tasks.size() > 0)
+      {
+        // Help out rather than sleep.  This also keeps nested waits from deadlocking
+        QueuedTask task = tasks.front();
+        tasks.pop_front();
+
+        mMutex.unlock();
+        execute(task);
+        mMutex.lock();
+      }
+      else
+      {
+        taskFinished.wait(mMutex);
+      }
+    }
+
+    bool failed = group->failed;
+    std::string error = group->error;
+    group->failed = false;
+    group->error = "";
+    mMutex.unlock();
+
+    if (failed)
+      throw std::runtime_error("Thread pool task failed: " + error);
+  }
+
+  unsigned int ThreadPool::numThreads()
+  {
+    return workers.size();
+  }
+
+  void ThreadPool::execute(QueuedTask task)
+  {
+    // An exception must not escape a worker thread (which would terminate the process), and the
+    // task must always be counted as finished, or its group would wait forever
+    bool failed = false;
+    std::string error;
+    try
+    {
+      task.func(task.arg);
+    }
+    catch (std::exception& e)
+    {
+      failed = true;
+      error = e.what();
+    }
+    catch (...)
+    {
+      failed = true;
+      error = "unknown exception";
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(mMutex);
+    if (task.group != NULL)
+    {
+      if (failed && !task.group->failed)
+      {
+        task.group->failed = true;
+        task.group->error = error;
+      }
+      task.group->pending--;
+    }
+
+    taskFinished.notify_all();
+  }
+
+  void ThreadPool::workerThread(void* arg)
+  {
+    ThreadPool* pool = (ThreadPool*) arg;
+
+    while (true)
+    {
+      QueuedTask task;
+
+      pool->mMutex.lock();
+      while (pool->active && pool->tasks.size() == 0)
+        pool->taskAvailable.wait(pool->mMutex);
+
+      if (pool->tasks.size() == 0)
+      {
+        // Pool is shutting down and the queue is drained
+        pool->mMutex.unlock();
+        return;
+      }
+
+      task = pool->tasks.front();
+      pool->tasks.pop_front();
+      pool->mMutex.unlock();
+
+      pool->execute(task);
+    }
+  }
+
+}
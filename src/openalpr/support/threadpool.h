@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_THREADPOOL_H
+#define OPENALPR_THREADPOOL_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "tinythread.h"
+
+namespace alpr
+{
+
+  typedef void (*ThreadPoolTask)(void* arg);
+
+  // Tracks a set of tasks submitted to a ThreadPool so that the caller can wait
+  // for its own work without waiting on tasks queued by other callers.
+  class TaskGroup
+  {
+    public:
+      TaskGroup() { pending = 0; failed = false; }
+
+    private:
+      friend class ThreadPool;
+      int pending;
+
+      // The first exception thrown by one of the tasks.  wait() rethrows it on the waiting thread
+      bool failed;
+      std::string error;
+  };
+
+  // Fixed-size pool of worker threads.  A thread that waits on a TaskGroup helps
+  // execute queued tasks while it waits, so tasks may safely queue (and wait on)
+  // more work on the same pool.  A pool with zero threads runs every task on the
+  // waiting thread.
+  class ThreadPool
+  {
+    public:
+      ThreadPool(unsigned int num_threads);
+      virtual ~ThreadPool();
+
+      void enqueue(ThreadPoolTask task, void* arg, TaskGroup* group);
+
+      // Returns once every task in the group has finished.  If any of them threw, the rest still
+      // run to completion, then a std::runtime_error describing the first failure is thrown
+      void wait(TaskGroup* group);
+
+      unsigned int numThreads();
+
+    private:
+
+      struct QueuedTask
+      {
+        ThreadPoolTask func;
+        void* arg;
+        TaskGroup* group;
+      };
+
+      bool active;
+
+      std::deque<QueuedTask> tasks;
+      std::vector<tthread::thread*> workers;
+
+      tthread::mutex mMutex;
+      tthread::condition_variable taskAvailable;
+      tthread::condition_variable taskFinished;
+
+      void execute(QueuedTask task);
+
+      static void workerThread(void* arg);
+  };
+
+}
+
+#endif // OPENALPR_THREADPOOL_H
@@ -54,8 +54,12 @@ namespace alpr
     if (config->always_invert)
       bitwise_not(pipeline_data->crop_gray, pipeline_data->crop_gray);
 
+    timespec thresholdsStartTime;
+    getTimeMonotonic(&thresholdsStartTime);
+
     pipeline_data->clearThresholds();
-    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config);
+    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config, pipeline_data->arena);
+    pipeline_data->addStageTime(STAGE_THRESHOLDS, thresholdsStartTime);
 
     timespec contoursStartTime;
     getTimeMonotonic(&contoursStartTime);
@@ -95,6 +99,9 @@ namespace alpr
       cout << "  -- Character Analysis Filter Time: " << diffclock(filterStartTime, filterEndTime) << "ms." << endl;
     }
 
+    // Finding and filtering the contours together make up the contours stage
+    pipeline_data->addStageTime(STAGE_CONTOURS, contoursStartTime);
+
     PlateMask plateMask(pipeline_data);
     plateMask.findOuterBoxMask(allTextContours);
 
@@ -133,6 +140,7 @@ namespace alpr
     {
       pipeline_data->disqualified = true;
       pipeline_data->disqualify_reason = "Low best fit score in characteranalysis";
+      pipeline_data->disqualify_stage = "character_analysis";
       return;
     }
 
@@ -157,7 +165,8 @@ namespace alpr
     if (config->multiline && config->auto_invert && pipeline_data->plate_inverted)
     {
       bitwise_not(pipeline_data->crop_gray, pipeline_data->crop_gray);
-      pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, pipeline_data->config);
+      pipeline_data->clearThresholds();
+      pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, pipeline_data->config, pipeline_data->arena);
     }
       
     
@@ -225,6 +234,7 @@ namespace alpr
       {
         pipeline_data->disqualified = true;
         pipeline_data->disqualify_reason = "Low confidence in characteranalysis";
+        pipeline_data->disqualify_stage = "character_analysis";
       }
       else
       {
@@ -236,6 +246,7 @@ namespace alpr
     {
         pipeline_data->disqualified = true;
         pipeline_data->disqualify_reason = "No text lines found in characteranalysis";
+        pipeline_data->disqualify_stage = "character_analysis";
     }
 
     if (config->debugTiming)
@@ -279,7 +290,7 @@ namespace alpr
 
   Mat CharacterAnalysis::getCharacterMask()
   {
-    Mat charMask = Mat::zeros(bestThreshold.size(), CV_8U);
+    Mat charMask = pipeline_data->getZeroImage(bestThreshold.size(), CV_8U);
 
     for (unsigned int i = 0; i < bestContours.size(); i++)
     {
@@ -497,7 +508,7 @@ namespace alpr
 
 
     // Create a white mask for the area inside the polygon
-    Mat outerMask = Mat::zeros(img.size(), CV_8U);
+    Mat outerMask = pipeline_data->getZeroImage(img.size(), CV_8U);
 
     for (unsigned int i = 0; i < textLines.size(); i++)
       fillConvexPoly(outerMask, textLines[i].linePolygon.data(), textLines[i].linePolygon.size(), Scalar(255,255,255));
@@ -575,8 +586,8 @@ namespace alpr
 
     cv::Mat plateMask = pipeline_data->plateBorderMask;
 
-    Mat tempMaskedContour = Mat::zeros(plateMask.size(), CV_8U);
-    Mat tempFullContour = Mat::zeros(plateMask.size(), CV_8U);
+    Mat tempMaskedContour = pipeline_data->getZeroImage(plateMask.size(), CV_8U);
+    Mat tempFullContour = pipeline_data->getZeroImage(plateMask.size(), CV_8U);
 
     int charsInsideMask = 0;
     int totalChars = 0;
@@ -591,7 +602,7 @@ namespace alpr
         continue;
 
       totalChars++;
-      tempFullContour = Mat::zeros(plateMask.size(), CV_8U);
+      tempFullContour = pipeline_data->getZeroImage(plateMask.size(), CV_8U);
       drawContours(tempFullContour, textContours.contours, i, Scalar(255,255,255), CV_FILLED, 8, textContours.hierarchy);
       bitwise_and(tempFullContour, plateMask, tempMaskedContour);
       
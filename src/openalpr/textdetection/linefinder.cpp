@@ -124,7 +124,7 @@ namespace alpr
       
       Size cropped_quad_size(distanceBetweenPoints(histogramArea[0], histogramArea[1]), distanceBetweenPoints(histogramArea[0], histogramArea[3]));
       
-      Mat mask = Mat::zeros(cropped_quad_size, CV_8U);
+      Mat mask = pipeline_data->getZeroImage(cropped_quad_size, CV_8U);
       bitwise_not(mask, mask);
 
       vector<Point2f> inputQuad;
@@ -160,7 +160,7 @@ namespace alpr
       
       for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
       {
-        Mat warpedImage = Mat::zeros(cropped_quad_size, CV_8U);
+        Mat warpedImage = pipeline_data->getZeroImage(cropped_quad_size, CV_8U);
         warpPerspective(pipeline_data->thresholds[i], warpedImage, 
                         trans_matrix, 
                         cropped_quad_size);
@@ -402,7 +402,7 @@ namespace alpr
       cout << "The winning score is: " << bestScore << endl;
       // Draw the winning line segment
 
-      Mat tempImg = Mat::zeros(Size(contours.width, contours.height), CV_8U);
+      Mat tempImg = pipeline_data->getZeroImage(Size(contours.width, contours.height), CV_8U);
       cvtColor(tempImg, tempImg, CV_GRAY2BGR);
 
       cv::line(tempImg, topLines[bestScoreIndex].p1, topLines[bestScoreIndex].p2, Scalar(0, 0, 255), 2);
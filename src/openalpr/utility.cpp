@@ -50,6 +50,55 @@ namespace alpr
     return expandedRegion;
   }
 
+  vector<Rect> removeContainedRects(vector<Rect> rects)
+  {
+    vector<Rect> kept;
+    for (unsigned int i = 0; i < rects.size(); i++)
+    {
+      bool contained = false;
+      for (unsigned int j = 0; j < rects.size() && !contained; j++)
+      {
+        if (i == j)
+          continue;
+
+        // Of two identical rectangles, keep the first
+        if (rects[i] == rects[j])
+          contained = j < i;
+        else
+          contained = (rects[i] & rects[j]) == rects[i];
+      }
+
+      if (!contained)
+        kept.push_back(rects[i]);
+    }
+
+    return kept;
+  }
+
+  vector<Rect> mergeOverlappingRects(vector<Rect> rects)
+  {
+    bool merged = true;
+    while (merged)
+    {
+      merged = false;
+      for (unsigned int i = 0; i < rects.size() && !merged; i++)
+      {
+        for (unsigned int j = i + 1; j < rects.size(); j++)
+        {
+          if ((rects[i] & rects[j]).area() > 0)
+          {
+            rects[i] = rects[i] | rects[j];
+            rects.erase(rects.begin() + j);
+            merged = true;
+            break;
+          }
+        }
+      }
+    }
+
+    return rects;
+  }
+
   Mat drawImageDashboard(vector<Mat> images, int imageType, unsigned int numColumns)
   {
     unsigned int numRows = ceil((float) images.size() / (float) numColumns);
@@ -120,47 +169,42 @@ namespace alpr
     }
   }
 
-  vector<Mat> produceThresholds(const Mat img_gray, Config* config)
+  vector<Mat> produceThresholds(const Mat img_gray, Config* config, MatArena* arena)
   {
-    const int THRESHOLD_COUNT = 3;
     //Mat img_equalized = equalizeBrightness(img_gray);
 
     timespec startTime;
     getTimeMonotonic(&startTime);
 
-    vector<Mat> thresholds;
-
-    for (int i = 0; i < THRESHOLD_COUNT; i++)
-      thresholds.push_back(Mat(img_gray.size(), CV_8U));
-
-    int i = 0;
-
     // Adaptive
     //adaptiveThreshold(img_gray, thresholds[i++], 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY_INV , 7, 3);
     //adaptiveThreshold(img_gray, thresholds[i++], 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY_INV , 13, 3);
     //adaptiveThreshold(img_gray, thresholds[i++], 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY_INV , 17, 3);
 
+    vector<ThresholdSettings> settings;
+
     // Wolf
     int k = 0, win=18;
-    //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
-    //bitwise_not(thresholds[i-1], thresholds[i-1]);
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
-    bitwise_not(thresholds[i-1], thresholds[i-1]);
+    settings.push_back(thresholdSettings(WOLFJOLION, win, win, 0.05 + (k * 0.35)));
 
     k = 1;
     win = 22;
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
-    bitwise_not(thresholds[i-1], thresholds[i-1]);
-    //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
-    //bitwise_not(thresholds[i-1], thresholds[i-1]);
+    settings.push_back(thresholdSettings(WOLFJOLION, win, win, 0.05 + (k * 0.35)));
 
     // Sauvola
     k = 1;
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], SAUVOLA, 12, 12, 0.18 * k);
-    bitwise_not(thresholds[i-1], thresholds[i-1]);
+    settings.push_back(thresholdSettings(SAUVOLA, 12, 12, 0.18 * k));
     //k=2;
-    //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], SAUVOLA, 12, 12, 0.18 * k);
-    //bitwise_not(thresholds[i-1], thresholds[i-1]);
+    //settings.push_back(thresholdSettings(SAUVOLA, 12, 12, 0.18 * k));
+
+    // All of the thresholds share one set of integral images, and come out inverted
+    vector<Mat> thresholds;
+    if (arena != NULL)
+    {
+      for (unsigned int i = 0; i < settings.size(); i++)
+        thresholds.push_back(arena->get(img_gray.size(), CV_8U));
+    }
+    NiblackSauvolaWolfJolion(img_gray, thresholds, settings, true);
 
     if (config->debugTiming)
     {
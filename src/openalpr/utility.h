@@ -30,6 +30,7 @@
 #include "opencv2/core/core.hpp"
 #include "binarize_wolf.h"
 #include "config.h"
+#include "mat_arena.h"
 
 namespace alpr
 {
@@ -74,7 +75,8 @@ namespace alpr
 
   double median(int array[], int arraySize);
 
-  std::vector<cv::Mat> produceThresholds(const cv::Mat img_gray, Config* config);
+  // The threshold images come from the arena, when there is one
+  std::vector<cv::Mat> produceThresholds(const cv::Mat img_gray, Config* config, MatArena* arena = NULL);
 
   cv::Mat drawImageDashboard(std::vector<cv::Mat> images, int imageType, unsigned int numColumns);
 
@@ -99,6 +101,12 @@ namespace alpr
 
   cv::Rect expandRect(cv::Rect original, int expandXPixels, int expandYPixels, int maxX, int maxY);
 
+  // Replaces overlapping rectangles with their bounding rectangle, until none overlap
+  std::vector<cv::Rect> mergeOverlappingRects(std::vector<cv::Rect> rects);
+
+  // Drops rectangles that are identical to, or lie entirely inside, another one.  The rest are kept as they are
+  std::vector<cv::Rect> removeContainedRects(std::vector<cv::Rect> rects);
+
   cv::Mat addLabel(cv::Mat input, std::string label);
 
   // Given 4 random points (Point2f array), order them as top-left, top-right, bottom-right, bottom-left
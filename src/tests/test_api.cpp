@@ -10,6 +10,8 @@
 #include <cstdlib>
 #include "catch.hpp"
 #include "alpr.h"
+#include "json_writer.h"
+#include "binary_results.h"
 #include "support/timing.h"
 
 
@@ -52,6 +54,14 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
           
   origResults.plates.push_back(apr);
   
+  AlprStageTime detectTime;
+  detectTime.stage = "detect";
+  detectTime.time_ms = 12.5;
+  origResults.stage_times.push_back(detectTime);
+  AlprStageTime ocrTime;
+  ocrTime.stage = "ocr";
+  ocrTime.time_ms = 3.25;
+  origResults.stage_times.push_back(ocrTime);
   
   std::string resultsJson = Alpr::toJson(origResults);
   AlprResults roundTrip = Alpr::fromJson(resultsJson);
@@ -70,6 +80,13 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
     REQUIRE( roundTrip.regionsOfInterest[i].height == origResults.regionsOfInterest[i].height);
   }
   
+  REQUIRE( roundTrip.stage_times.size() == origResults.stage_times.size() );
+  for (int i = 0; i < roundTrip.stage_times.size(); i++)
+  {
+    REQUIRE( roundTrip.stage_times[i].stage == origResults.stage_times[i].stage);
+    REQUIRE( roundTrip.stage_times[i].time_ms == origResults.stage_times[i].time_ms);
+  }
+  
   REQUIRE( roundTrip.plates.size() == origResults.plates.size() );
   for (int i = 0; i < roundTrip.plates.size(); i++)
   {
@@ -93,3 +110,151 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
   }
   
 }
+
+TEST_CASE( "JSON writer with extra fields", "[json]" ) {
+
+  AlprResults origResults;
+  origResults.epoch_time = getEpochTimeMs();
+  origResults.frame_number = 42;
+  origResults.img_width = 1920;
+  origResults.img_height = 1080;
+  origResults.total_processing_time_ms = 57.5;
+
+  AlprPlateResult apr;
+  AlprPlate ap;
+  ap.characters = "a\"b\\c\n";
+  ap.matches_template = true;
+  ap.overall_confidence = 91.25;
+  apr.topNPlates.push_back(ap);
+  apr.bestPlate = ap;
+  for (int i = 0; i < 4; i++)
+  {
+    apr.plate_points[i].x = i * 10;
+    apr.plate_points[i].y = -i;
+  }
+  apr.processing_time_ms = 12;
+  apr.plate_index = 0;
+  apr.requested_topn = 5;
+  apr.region = "";
+  apr.regionConfidence = 0;
+  origResults.plates.push_back(apr);
+
+  JsonWriter writer;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    // The buffer is reused, and must come out the same every time
+    writer.clear();
+    writer.beginObject();
+    writer.addField("filename", "first.jpg");
+    writer.addResultsFields(origResults);
+    writer.addField("uuid", "site-cam1-123");
+    writer.addField("camera_id", 7);
+    writer.endObject();
+
+    std::string json = writer.str();
+    REQUIRE( json.find("\"filename\":\"first.jpg\"") != std::string::npos );
+    REQUIRE( json.find("\"uuid\":\"site-cam1-123\",\"camera_id\":7}") != std::string::npos );
+
+    AlprResults roundTrip = Alpr::fromJson(json);
+    REQUIRE( roundTrip.epoch_time == origResults.epoch_time );
+    REQUIRE( roundTrip.frame_number == origResults.frame_number );
+    REQUIRE( roundTrip.img_width == origResults.img_width );
+    REQUIRE( roundTrip.img_height == origResults.img_height );
+    REQUIRE( roundTrip.plates.size() == 1 );
+    REQUIRE( roundTrip.plates[0].bestPlate.characters == ap.characters );
+    REQUIRE( roundTrip.plates[0].bestPlate.matches_template == ap.matches_template );
+    REQUIRE( roundTrip.plates[0].bestPlate.overall_confidence == ap.overall_confidence );
+    REQUIRE( roundTrip.plates[0].processing_time_ms == apr.processing_time_ms );
+    for (int i = 0; i < 4; i++)
+    {
+      REQUIRE( roundTrip.plates[0].plate_points[i].x == apr.plate_points[i].x );
+      REQUIRE( roundTrip.plates[0].plate_points[i].y == apr.plate_points[i].y );
+    }
+  }
+
+}
+
+TEST_CASE( "Binary Serialization/Deserialization", "[binary]" ) {
+
+  AlprResults origResults;
+  origResults.epoch_time = getEpochTimeMs();
+  origResults.img_width = 640;
+  origResults.img_height = 480;
+  origResults.total_processing_time_ms = 100.125;
+  origResults.regionsOfInterest.push_back(AlprRegionOfInterest(0,0,100,200));
+
+  AlprPlateResult apr;
+  for (int i = 0; i < 3; i++)
+  {
+    AlprPlate ap;
+    ap.characters = "abc";
+    ap.matches_template = i%2;
+    ap.overall_confidence = 90 - i * 10.5;
+    apr.topNPlates.push_back(ap);
+  }
+  apr.bestPlate = apr.topNPlates[0];
+  for (int i = 0; i < 4; i++)
+  {
+    apr.plate_points[i].x = i - 2;
+    apr.plate_points[i].y = i * 100;
+  }
+  apr.processing_time_ms = 30;
+  apr.plate_index = 0;
+  apr.requested_topn = 10;
+  apr.region = "mo";
+  apr.regionConfidence = 80;
+  origResults.plates.push_back(apr);
+
+  AlprResults roundTrip = Alpr::fromBinary(Alpr::toBinary(origResults));
+
+  REQUIRE( roundTrip.epoch_time == origResults.epoch_time );
+  REQUIRE( roundTrip.frame_number == -1 );
+  REQUIRE( roundTrip.img_width == origResults.img_width );
+  REQUIRE( roundTrip.total_processing_time_ms == origResults.total_processing_time_ms );
+  REQUIRE( roundTrip.regionsOfInterest.size() == 1 );
+  REQUIRE( roundTrip.regionsOfInterest[0].height == 200 );
+  REQUIRE( roundTrip.plates.size() == 1 );
+  REQUIRE( roundTrip.plates[0].region == apr.region );
+  REQUIRE( roundTrip.plates[0].bestPlate.characters == apr.bestPlate.characters );
+  REQUIRE( roundTrip.plates[0].topNPlates.size() == apr.topNPlates.size() );
+  for (int i = 0; i < 4; i++)
+  {
+    REQUIRE( roundTrip.plates[0].plate_points[i].x == apr.plate_points[i].x );
+    REQUIRE( roundTrip.plates[0].plate_points[i].y == apr.plate_points[i].y );
+  }
+  for (int i = 0; i < apr.topNPlates.size(); i++)
+  {
+    REQUIRE( roundTrip.plates[0].topNPlates[i].overall_confidence == apr.topNPlates[i].overall_confidence );
+    REQUIRE( roundTrip.plates[0].topNPlates[i].matches_template == apr.topNPlates[i].matches_template );
+  }
+
+  // Concatenated records with extra fields, as alprd queues them
+  BinaryWriter writer;
+  writer.beginRecord(origResults);
+  writer.addField("uuid", "site-cam1-123");
+  writer.endRecord();
+  writer.beginRecord(apr);
+  writer.addField("group_id", (int64_t) 5);
+  writer.endRecord();
+
+  BinaryReader reader(writer.str());
+  BinaryRecord record;
+  REQUIRE( reader.next(&record) );
+  REQUIRE( record.type == BINARY_RECORD_RESULTS );
+  REQUIRE( record.string_fields["uuid"] == "site-cam1-123" );
+  REQUIRE( reader.next(&record) );
+  REQUIRE( record.type == BINARY_RECORD_PLATE_RESULT );
+  REQUIRE( record.plate.bestPlate.characters == apr.bestPlate.characters );
+  REQUIRE( record.int_fields["group_id"] == 5 );
+  REQUIRE( !reader.next(&record) );
+  REQUIRE( isBinaryRecords(writer.str()) );
+
+  // Truncated data is rejected rather than misread
+  std::string truncated = Alpr::toBinary(origResults);
+  truncated.resize(truncated.size() - 1);
+  REQUIRE( Alpr::fromBinary(truncated).plates.size() == 0 );
+  REQUIRE( !isBinaryRecords(truncated) );
+
+  REQUIRE( !isBinaryRecords(Alpr::toJson(origResults)) );
+  REQUIRE( !isBinaryRecords("") );
+}
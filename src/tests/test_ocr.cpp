@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "catch.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+#include "ocr/ocrcache.h"
+#include "ocr/charactermodel.h"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// A 16x32 character crop: a thick ring ("0"), optionally with a bar across the middle ("8")
+Mat makeCharacterCrop(bool middle_bar)
+{
+  Mat crop(32, 16, CV_8U, Scalar(255));
+  rectangle(crop, Point(2, 2), Point(13, 29), Scalar(0), CV_FILLED);
+  rectangle(crop, Point(5, 5), Point(10, 26), Scalar(255), CV_FILLED);
+
+  if (middle_bar)
+    rectangle(crop, Point(2, 14), Point(13, 17), Scalar(0), CV_FILLED);
+
+  return crop;
+}
+
+vector<OcrChar> makeChars(string letter)
+{
+  OcrChar ocr_char;
+  ocr_char.letter = letter;
+  ocr_char.char_index = 0;
+  ocr_char.confidence = 90;
+
+  vector<OcrChar> chars;
+  chars.push_back(ocr_char);
+  return chars;
+}
+
+TEST_CASE( "OCR cache keeps similar characters apart", "[OCR]" ) {
+
+  Mat zero = makeCharacterCrop(false);
+  Mat eight = makeCharacterCrop(true);
+
+  vector<uint64_t> zero_hashes(1, OcrCache::hashCrop(zero));
+  vector<uint64_t> eight_hashes(1, OcrCache::hashCrop(eight));
+
+  // The two hashes are only a few bits apart
+  REQUIRE( zero_hashes[0] != eight_hashes[0] );
+
+  OcrCache cache(16, 1);
+  cache.store(zero.size(), zero_hashes, makeChars("0"));
+
+  vector<OcrChar> chars;
+  REQUIRE( cache.lookup(eight.size(), eight_hashes, &chars) == false );
+
+  REQUIRE( cache.lookup(zero.size(), zero_hashes, &chars) == true );
+  REQUIRE( chars.size() == 1 );
+  REQUIRE( chars[0].letter == "0" );
+
+  // A crop with the same hash but a different shape is a different character
+  Mat wide_zero;
+  resize(zero, wide_zero, Size(32, 32), 0, 0, INTER_NEAREST);
+  vector<uint64_t> wide_hashes(1, OcrCache::hashCrop(wide_zero));
+  REQUIRE( wide_hashes[0] == zero_hashes[0] );
+  REQUIRE( cache.lookup(wide_zero.size(), wide_hashes, &chars) == false );
+
+  REQUIRE( cache.getHits() == 1 );
+  REQUIRE( cache.getMisses() == 2 );
+}
+
+// White text on black, like the plate thresholds.  "I" is a bar, "L" a bar with a foot
+Mat makeLetterCrop(string letter, int offset)
+{
+  Mat crop = Mat::zeros(30, 20, CV_8U);
+  rectangle(crop, Point(6 + offset, 3), Point(9 + offset, 26), Scalar(255), CV_FILLED);
+
+  if (letter == "L")
+    rectangle(crop, Point(6 + offset, 23), Point(16 + offset, 26), Scalar(255), CV_FILLED);
+
+  return crop;
+}
+
+string readFile(string filename)
+{
+  ifstream in(filename.c_str(), ios::in | ios::binary);
+  return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+void writeFile(string filename, string contents)
+{
+  ofstream out(filename.c_str(), ios::out | ios::binary);
+  out.write(contents.data(), contents.size());
+}
+
+TEST_CASE( "Character model save and load", "[OCR]" ) {
+
+  const string filename = "test_charactermodel.bin";
+
+  CharacterModel model;
+  for (int offset = 0; offset < 3; offset++)
+  {
+    model.addSample("I", makeLetterCrop("I", offset));
+    model.addSample("L", makeLetterCrop("L", offset));
+  }
+  model.calibrate(1);
+  REQUIRE( model.save(filename) );
+
+  CharacterModel loaded;
+  REQUIRE( loaded.load(filename) );
+  REQUIRE( loaded.getSampleCount() == 6 );
+  REQUIRE( loaded.getLabels() == model.getLabels() );
+  REQUIRE( loaded.getLabelCounts() == model.getLabelCounts() );
+
+  vector<CharacterMatch> expected = model.classify(makeLetterCrop("L", 1), 3);
+  vector<CharacterMatch> matches = loaded.classify(makeLetterCrop("L", 1), 3);
+  REQUIRE( matches.size() == expected.size() );
+  REQUIRE( matches[0].letter == "L" );
+  REQUIRE( matches[0].confidence == expected[0].confidence );
+
+  string contents = readFile(filename);
+
+  // A truncated file is rejected
+  writeFile(filename, contents.substr(0, contents.size() - 10));
+  CharacterModel truncated;
+  REQUIRE( truncated.load(filename) == false );
+  REQUIRE( truncated.isLoaded() == false );
+
+  // So is one that claims more samples than it holds.  The sample count follows the magic,
+  // version, feature length, max distance, label count and the two one letter labels
+  string corrupt = contents;
+  int sample_count_offset = 8 + 4 * 4 + 2 * (4 + 1);
+  corrupt[sample_count_offset + 2] = (char) 0x90;
+  writeFile(filename, corrupt);
+  CharacterModel oversized;
+  REQUIRE( oversized.load(filename) == false );
+
+  remove(filename.c_str());
+}
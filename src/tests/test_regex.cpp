@@ -1,7 +1,9 @@
 #include <cstdlib>
+#include <fstream>
 #include "utility.h"
 #include "catch.hpp"
 #include "postprocess/regexrule.h"
+#include "postprocess/patternmatcher.h"
 
 using namespace std;
 using namespace cv;
@@ -105,4 +107,152 @@ TEST_CASE( "Invalid tests", "[Regex]" ) {
   
   RegexRule rule2("us", "A####]", "\\pL", "\\pN");
   REQUIRE( rule2.match("A1234") == false);
-}
\ No newline at end of file
+}
+
+// PatternMatcher checks all of a region's rules at once.  It must agree with trying the rules one by one
+void requireSameMatches(const vector<RegexRule*>& rules, const vector<string>& texts)
+{
+  CompiledPatterns patterns(rules);
+  PatternMatcher matcher(&patterns);
+
+  for (unsigned int i = 0; i < texts.size(); i++)
+  {
+    bool expected = false;
+    for (unsigned int r = 0; r < rules.size(); r++)
+    {
+      if (rules[r]->match(texts[i]))
+        expected = true;
+    }
+
+    INFO( "Text: " << texts[i] );
+    REQUIRE( matcher.match(texts[i]) == expected );
+
+    matcher.reset();
+    matcher.add(texts[i]);
+    REQUIRE( matcher.matches() == expected );
+  }
+}
+
+void deleteRules(vector<RegexRule*>& rules)
+{
+  for (unsigned int i = 0; i < rules.size(); i++)
+    delete rules[i];
+  rules.clear();
+}
+
+// A plate that fits the pattern, taking the first choice of every character class
+string samplePlate(const string& pattern, int seed)
+{
+  const string letters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  const string numbers = "0123456789";
+
+  string plate;
+  for (unsigned int i = 0; i < pattern.size(); i++)
+  {
+    if (pattern[i] == '@')
+      plate += letters[(seed + i * 7) % letters.size()];
+    else if (pattern[i] == '#')
+      plate += numbers[(seed + i * 3) % numbers.size()];
+    else if (pattern[i] == '?')
+      plate += (seed + i) % 2 == 0 ? letters[(seed + i) % letters.size()] : numbers[(seed + i) % numbers.size()];
+    else if (pattern[i] == '[')
+    {
+      size_t end = pattern.find(']', i);
+      if (end == string::npos)
+        break;
+      plate += pattern[i + 1];
+      i = end;
+    }
+    else
+      plate += pattern[i];
+  }
+
+  return plate;
+}
+
+TEST_CASE( "Pattern matcher agrees with rules", "[Regex]" ) {
+
+  vector<RegexRule*> rules;
+  rules.push_back(new RegexRule("us", "@@@####", "[A-Za-z]", "[0-9]"));
+  rules.push_back(new RegexRule("us", "[ABC]@@####", "[A-Z]", "[0-9]"));
+  rules.push_back(new RegexRule("us", "[A]@@###[12]", "[A-Z]", "[0-9]"));
+  rules.push_back(new RegexRule("us", "[A-C][E-G]1111", "[A-Z]", "[0-9]"));
+  rules.push_back(new RegexRule("us", "\\d\\d\\D\\D", "[A-Z]", "[0-9]"));
+  rules.push_back(new RegexRule("us", "A\\-##", "[A-Z]", "[0-9]"));
+
+  const char* ascii_texts[] = { "123ABCD", "123ABC", "23ABCD", "ABC123", "BC1234", "ABC12345", "AABC1234",
+                                "ABCD234", "AB11234", "ABC-234", "ABC1234", "AAA1111", "zzz1111", "ZBC1234",
+                                "DBC1234", "BAA1111", "CAA1111", "ABC1231", "ABC1232", "DG1111", "AD1111",
+                                "AF1112", "AF1111", "BG1111", "AA11", "11AA", "A-12", "A-1", "AB12", "",
+                                "A", "ABC 1234", "abc1234" };
+  requireSameMatches(rules, vector<string>(ascii_texts, ascii_texts + sizeof(ascii_texts) / sizeof(ascii_texts[0])));
+  deleteRules(rules);
+
+  rules.push_back(new RegexRule("kr", "@@@####", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("kr", "[십팔]@@####", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("kr", "##@####", "\\pL", "\\pN"));
+
+  const char* unicode_texts[] = { "123与与与下", "与万12345", "与万口口234", "与万口abcd", "与万口1234",
+                                  "与팔십1234", "십万口1234", "팔万口1234", "12가3456", "12가345", "ÄÖÜ1234",
+                                  "ЖЖЖ1234", "\xff\xfe\xfd" "1234", "与万\xe5" };
+  requireSameMatches(rules, vector<string>(unicode_texts, unicode_texts + sizeof(unicode_texts) / sizeof(unicode_texts[0])));
+  deleteRules(rules);
+
+  // Rules that aren't a sequence of single characters are matched with the full regex
+  rules.push_back(new RegexRule("zz", "A|B", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("zz", "@#*", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("zz", "[^A]#", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("zz", "[A@@####", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("zz", "A####]", "\\pL", "\\pN"));
+  rules.push_back(new RegexRule("zz", "@@##", "\\pL", "\\pN"));
+
+  const char* fallback_texts[] = { "A", "B", "AB", "C", "C1", "C123", "A1", "B1", "AB12", "AB1", "[A1234",
+                                   "A1234]", "A1234", "", "与1", "与万12" };
+  requireSameMatches(rules, vector<string>(fallback_texts, fallback_texts + sizeof(fallback_texts) / sizeof(fallback_texts[0])));
+  deleteRules(rules);
+}
+
+TEST_CASE( "Pattern matcher agrees with rules for every country", "[Regex]" ) {
+
+  const char* countries[] = { "au", "br", "eu", "gb", "in", "kr", "mx", "sg", "us" };
+  const string extra_chars = "Z9-";
+
+  for (unsigned int c = 0; c < sizeof(countries) / sizeof(countries[0]); c++)
+  {
+    string filename = string(OPENALPR_TESTING_RUNTIME_DIR) + "/postprocess/" + countries[c] + ".patterns";
+    ifstream infile(filename.c_str());
+    REQUIRE( infile.is_open() );
+
+    map<string, vector<RegexRule*> > rules;
+    map<string, vector<string> > texts;
+
+    string region, pattern;
+    while (infile >> region >> pattern)
+    {
+      rules[region].push_back(new RegexRule(region, pattern, "\\pL", "\\pN"));
+
+      // Plates that fit the pattern, and near misses with a character changed, dropped or added
+      for (int seed = 0; seed < 3; seed++)
+      {
+        string plate = samplePlate(pattern, seed);
+        texts[region].push_back(plate);
+
+        if (plate.size() == 0)
+          continue;
+
+        string changed = plate;
+        changed[seed % changed.size()] = extra_chars[seed];
+        texts[region].push_back(changed);
+        texts[region].push_back(plate.substr(0, plate.size() - 1));
+        texts[region].push_back(plate + extra_chars[seed]);
+      }
+    }
+
+    for (map<string, vector<RegexRule*> >::iterator it = rules.begin(); it != rules.end(); ++it)
+    {
+      INFO( "Region: " << countries[c] << " " << it->first );
+      requireSameMatches(it->second, texts[it->first]);
+      deleteRules(it->second);
+    }
+  }
+}
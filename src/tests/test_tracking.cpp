@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include "catch.hpp"
+#include "config.h"
+#include "plate_tracker.h"
+#include "detection_scheduler.h"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+AlprPlateResult makePlate(string characters, int x, int y)
+{
+  AlprPlateResult plate;
+  plate.bestPlate.characters = characters;
+  plate.bestPlate.overall_confidence = 90;
+  plate.bestPlate.matches_template = false;
+  plate.topNPlates.push_back(plate.bestPlate);
+
+  plate.plate_points[0].x = x;        plate.plate_points[0].y = y;
+  plate.plate_points[1].x = x + 100;  plate.plate_points[1].y = y;
+  plate.plate_points[2].x = x + 100;  plate.plate_points[2].y = y + 50;
+  plate.plate_points[3].x = x;        plate.plate_points[3].y = y + 50;
+
+  return plate;
+}
+
+bool coversPoint(const vector<Rect>& regions, Point point)
+{
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    if (regions[i].contains(point))
+      return true;
+  }
+  return false;
+}
+
+TEST_CASE( "Tracked regions add to the search regions", "[Tracking]" ) {
+
+  Config config("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  PlateTracker tracker(&config, 10, 1500);
+
+  AlprResults first_frame;
+  first_frame.plates.push_back(makePlate("ABC1234", 100, 100));
+  tracker.addFrame(first_frame, 1000, "frame1");
+  REQUIRE( tracker.activeTracks() == 1 );
+
+  // A second plate enters on the far side of the frame, where motion detection (say) sees it
+  vector<Rect> motion_regions;
+  motion_regions.push_back(Rect(1400, 800, 300, 200));
+
+  vector<Rect> regions = tracker.addTrackedRegions(motion_regions, 1040, 1920, 1080);
+
+  REQUIRE( coversPoint(regions, Point(150, 125)) );    // The tracked plate
+  REQUIRE( coversPoint(regions, Point(1550, 900)) );   // The new plate
+  REQUIRE( coversPoint(tracker.predictRegions(1040, 1920, 1080), Point(1550, 900)) == false );
+
+  // Both plates are read in the next frame.  The new one starts its own track
+  AlprResults second_frame;
+  second_frame.plates.push_back(makePlate("ABC1234", 104, 100));
+  second_frame.plates.push_back(makePlate("XYZ9876", 1500, 850));
+  tracker.addFrame(second_frame, 1040, "frame2");
+  REQUIRE( tracker.activeTracks() == 2 );
+
+  vector<PlateGroup> groups = tracker.flush();
+  REQUIRE( groups.size() == 2 );
+
+  // A full frame region already covers every tracked area
+  tracker.addFrame(second_frame, 1080, "frame3");
+  vector<Rect> full_frame;
+  full_frame.push_back(Rect(0, 0, 1920, 1080));
+  REQUIRE( tracker.addTrackedRegions(full_frame, 1120, 1920, 1080).size() == 1 );
+}
+
+TEST_CASE( "Scheduled full scans happen while plates are found", "[Tracking]" ) {
+
+  Config config("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  config.detectionScheduleColumns = 2;
+  config.detectionScheduleRows = 2;
+  config.detectionScheduleFullScanInterval = 3;
+  config.detectionScheduleHitTimeoutMs = 2000;
+
+  DetectionScheduler scheduler(&config);
+  Rect full_frame(0, 0, 1920, 1080);
+
+  for (int frame = 0; frame < 9; frame++)
+  {
+    int64_t frame_time = 1000 + frame * 40;
+    vector<Rect> regions = scheduler.nextRegions(frame_time, 1920, 1080);
+
+    if (frame % 3 == 0)
+    {
+      REQUIRE( regions.size() == 1 );
+      REQUIRE( regions[0] == full_frame );
+    }
+    else
+    {
+      REQUIRE( regions.size() > 0 );
+      for (unsigned int i = 0; i < regions.size(); i++)
+        REQUIRE( regions[i].area() < full_frame.area() );
+    }
+
+    // A plate is read in every frame
+    AlprResults results;
+    results.plates.push_back(makePlate("ABC1234", 100 + frame * 4, 100));
+    scheduler.addResults(results, frame_time);
+  }
+}
@@ -63,4 +63,91 @@ TEST_CASE( "Test Levenshtein Distance", "[levenshtein]" ) {
   
   REQUIRE( levenshteinDistance("", "AAAA", 2) == 2 );
   REQUIRE( levenshteinDistance("BA", "AAAA", 2) == 2 );
-}
\ No newline at end of file
+}
+// Dark and light blocks with some noise, like characters on a plate
+Mat makeStripedImage(int rows, int cols)
+{
+  Mat im(rows, cols, CV_8U);
+  for (int y = 0; y < rows; y++)
+  {
+    for (int x = 0; x < cols; x++)
+      im.at<unsigned char>(y, x) = (((x / 7) + (y / 5)) % 2 ? 200 : 40) + rand() % 20;
+  }
+
+  return im;
+}
+
+// The fused thresholds must be exactly what one NiblackSauvolaWolfJolion call per setting produces
+void requireSameThresholds(Mat im, bool invert)
+{
+  vector<ThresholdSettings> settings;
+  settings.push_back(thresholdSettings(WOLFJOLION, 18, 18, 0.05));
+  settings.push_back(thresholdSettings(WOLFJOLION, 22, 22, 0.40));
+  settings.push_back(thresholdSettings(SAUVOLA, 12, 12, 0.18));
+  settings.push_back(thresholdSettings(NIBLACK, 13, 7, -0.2));
+
+  vector<Mat> outputs;
+  NiblackSauvolaWolfJolion(im, outputs, settings, invert);
+  REQUIRE( outputs.size() == settings.size() );
+
+  for (unsigned int t = 0; t < settings.size(); t++)
+  {
+    // Windows that don't fit are shrunk to the largest odd size that does
+    int winx = std::min(settings[t].winx, im.cols - (1 - im.cols % 2));
+    int winy = std::min(settings[t].winy, im.rows - (1 - im.rows % 2));
+
+    Mat expected(im.rows, im.cols, CV_8U);
+    NiblackSauvolaWolfJolion(im, expected, settings[t].version, winx, winy, settings[t].k, settings[t].dR);
+    if (invert)
+      bitwise_not(expected, expected);
+
+    int differences = 0;
+    for (int y = 0; y < im.rows; y++)
+    {
+      for (int x = 0; x < im.cols; x++)
+      {
+        if (outputs[t].at<unsigned char>(y, x) != expected.at<unsigned char>(y, x))
+          differences++;
+      }
+    }
+
+    INFO( "Image " << im.cols << "x" << im.rows << ", setting " << t << ", invert " << invert );
+    REQUIRE( differences == 0 );
+  }
+}
+
+TEST_CASE( "Fused thresholds match each setting", "[binarize]" ) {
+
+  srand(3);
+
+  // A plate crop, odd and even sizes, and crops smaller than every window
+  int sizes[][2] = { {120, 60}, {31, 23}, {30, 24}, {15, 9}, {8, 14}, {5, 5} };
+
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    Mat im = makeStripedImage(sizes[i][1], sizes[i][0]);
+    requireSameThresholds(im, false);
+    requireSameThresholds(im, true);
+  }
+
+  // A flat image has no contrast anywhere
+  Mat flat = Mat::zeros(40, 100, CV_8U);
+  requireSameThresholds(flat, true);
+}
+
+TEST_CASE( "Remove contained rectangles", "[2d primitives]" ) {
+
+  vector<Rect> rects;
+  rects.push_back(Rect(0, 0, 100, 100));
+  rects.push_back(Rect(10, 10, 20, 20));    // Inside the first
+  rects.push_back(Rect(50, 50, 100, 100));  // Overlaps the first
+  rects.push_back(Rect(0, 0, 100, 100));    // Same as the first
+  rects.push_back(Rect(200, 200, 10, 10));
+
+  vector<Rect> kept = removeContainedRects(rects);
+
+  REQUIRE( kept.size() == 3 );
+  REQUIRE( kept[0] == Rect(0, 0, 100, 100) );
+  REQUIRE( kept[1] == Rect(50, 50, 100, 100) );
+  REQUIRE( kept[2] == Rect(200, 200, 10, 10) );
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ * 
+ * This file is part of OpenALPR.
+ * 
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License 
+ * version 3 as published by the Free Software Foundation 
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framepool.h"
+
+FramePool::FramePool(int max_buffers)
+{
+  this->max_buffers = max_buffers;
+
+  frames_reused = 0;
+  frames_allocated = 0;
+  frames_overflowed = 0;
+}
+
+FramePool::~FramePool()
+{
+  for (unsigned int i = 0; i < buffers.size(); i++)
+    delete buffers[i];
+}
+
+cv::Mat* FramePool::acquire()
+{
+  tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+  for (unsigned int i = 0; i < buffers.size(); i++)
+  {
+    if (!isReferenced(buffers[i]))
+    {
+      frames_reused++;
+      return buffers[i];
+    }
+  }
+
+  if ((int) buffers.size() >= max_buffers)
+    return NULL;
+
+  // The buffer itself is allocated by the first decode into it
+  cv::Mat* buffer = new cv::Mat();
+  buffers.push_back(buffer);
+  frames_allocated++;
+
+  return buffer;
+}
+
+void FramePool::overflow()
+{
+  tthread::lock_guard<tthread::mutex> guard(mMutex);
+  frames_overflowed++;
+}
+
+FramePoolStats FramePool::getStats()
+{
+  tthread::lock_guard<tthread::mutex> guard(mMutex);
+
+  FramePoolStats stats;
+  stats.buffers = buffers.size();
+  stats.buffers_in_use = 0;
+  for (unsigned int i = 0; i < buffers.size(); i++)
+  {
+    if (isReferenced(buffers[i]))
+      stats.buffers_in_use++;
+  }
+  stats.frames_reused = frames_reused;
+  stats.frames_allocated = frames_allocated;
+  stats.frames_overflowed = frames_overflowed;
+
+  return stats;
+}
+
+bool FramePool::isReferenced(cv::Mat* buffer)
+{
+  // The pool holds one reference.  Anything above that is a frame that's still in flight.
+  // Other threads release their references concurrently, so the count is read atomically
+  // (adding 0) to see their latest decrement.  Once it drops to 1 nobody else can take a
+  // new reference
+#if CV_MAJOR_VERSION >= 3
+  return buffer->u != NULL && CV_XADD(&buffer->u->refcount, 0) > 1;
+#else
+  return buffer->refcount != NULL && CV_XADD(buffer->refcount, 0) > 1;
+#endif
+}
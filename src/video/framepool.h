@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_FRAMEPOOL_H
+#define OPENALPR_FRAMEPOOL_H
+
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+#include "support/tinythread.h"
+
+// Enough for a couple of frames queued for each of a few analysis threads.  Callers that know
+// how many frames they keep in flight should size the pool from that instead
+#define DEFAULT_FRAME_POOL_SIZE 8
+
+struct FramePoolStats
+{
+  // Buffers currently owned by the pool, and how many of them are referenced outside of it
+  int buffers;
+  int buffers_in_use;
+
+  // Frames handed out by reusing an idle buffer vs. adding a new buffer to the pool
+  long frames_reused;
+  long frames_allocated;
+
+  // Frames that could not be pooled because every buffer was in use
+  long frames_overflowed;
+};
+
+// Recycles decoded frame buffers.  A frame is decoded directly into a pooled cv::Mat and
+// travels to the recognizers as a shallow copy of it.  A buffer becomes available for the
+// next frame once every cv::Mat that references it (other than the pool's own) is released,
+// so a frame that is still being analyzed is never overwritten.
+class FramePool
+{
+  public:
+    FramePool(int max_buffers);
+    virtual ~FramePool();
+
+    // Returns a buffer that nothing else references, for the caller to decode into.
+    // Returns NULL if every buffer is in use and the pool is full.  Only one thread
+    // (the one producing frames) may acquire buffers.
+    cv::Mat* acquire();
+
+    // Records that the caller had to fall back to an unpooled frame
+    void overflow();
+
+    FramePoolStats getStats();
+
+  private:
+    int max_buffers;
+    std::vector<cv::Mat*> buffers;
+
+    long frames_reused;
+    long frames_allocated;
+    long frames_overflowed;
+
+    tthread::mutex mMutex;
+
+    bool isReferenced(cv::Mat* buffer);
+};
+
+#endif // OPENALPR_FRAMEPOOL_H
@@ -9,8 +9,8 @@
 class LoggingVideoDispatcher : public VideoDispatcher
 {
   public:
-    LoggingVideoDispatcher(std::string mjpeg_url, int fps, log4cplus::Logger logger) : 
-      VideoDispatcher(mjpeg_url, fps)
+    LoggingVideoDispatcher(std::string mjpeg_url, int fps, int frame_pool_size, log4cplus::Logger logger) : 
+      VideoDispatcher(mjpeg_url, fps, frame_pool_size)
       {
 	this->logger = logger;
       }
@@ -39,9 +39,9 @@ class LoggingVideoBuffer : public VideoBuffer
   
   protected:
     
-    virtual VideoDispatcher* createDispatcher(std::string mjpeg_url, int fps)
+    virtual VideoDispatcher* createDispatcher(std::string mjpeg_url, int fps, int frame_pool_size)
     {
-      return new LoggingVideoDispatcher(mjpeg_url, fps, logger);
+      return new LoggingVideoDispatcher(mjpeg_url, fps, frame_pool_size, logger);
     }
   
   private:
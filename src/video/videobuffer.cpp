@@ -39,12 +39,12 @@ VideoBuffer::~VideoBuffer()
   }
 }
 
-VideoDispatcher* VideoBuffer::createDispatcher(std::string mjpeg_url, int fps)
+VideoDispatcher* VideoBuffer::createDispatcher(std::string mjpeg_url, int fps, int frame_pool_size)
 {
-  return new VideoDispatcher(mjpeg_url, fps);
+  return new VideoDispatcher(mjpeg_url, fps, frame_pool_size);
 }
 
-void VideoBuffer::connect(std::string mjpeg_url, int fps)
+void VideoBuffer::connect(std::string mjpeg_url, int fps, int frame_pool_size)
 {
   
     if (startsWith(mjpeg_url, "http") && hasEnding(mjpeg_url, ".mjpg") == false)
@@ -67,7 +67,7 @@ void VideoBuffer::connect(std::string mjpeg_url, int fps)
 
     }
     
-    dispatcher = createDispatcher(mjpeg_url, fps);
+    dispatcher = createDispatcher(mjpeg_url, fps, frame_pool_size);
       
     tthread::thread* t = new tthread::thread(imageCollectionThread, (void*) dispatcher);
     
@@ -82,6 +82,17 @@ int VideoBuffer::getLatestFrame(cv::Mat* frame, std::vector<cv::Rect>& regionsOf
 }
 
 
+FramePoolStats VideoBuffer::getFramePoolStats()
+{
+  if (dispatcher == NULL)
+  {
+    FramePoolStats empty_stats = FramePoolStats();
+    return empty_stats;
+  }
+
+  return dispatcher->framePool.getStats();
+}
+
 void VideoBuffer::disconnect()
 {
   if (dispatcher != NULL)
@@ -177,8 +188,20 @@ void getALPRImages(cv::VideoCapture cap, VideoDispatcher* dispatcher)
       bool hasImage = false;
       try
       {
+        // Decode straight into a pooled buffer.  The recognizers share it rather than copying it
         cv::Mat frame;
-	hasImage = cap.read(frame);
+        cv::Mat* buffer = dispatcher->framePool.acquire();
+        if (buffer != NULL)
+        {
+          hasImage = cap.read(*buffer);
+          frame = *buffer;
+        }
+        else
+        {
+          dispatcher->framePool.overflow();
+          hasImage = cap.read(frame);
+        }
+
 		  // Double check the image to make sure it's valid.
 	if (!frame.data || frame.empty())
 	{
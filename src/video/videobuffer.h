@@ -13,12 +13,14 @@
 #include "support/tinythread.h"
 #include "support/platform.h"
 
+#include "framepool.h"
+
 
 
 class VideoDispatcher
 {
   public:
-    VideoDispatcher(std::string mjpeg_url, int fps)
+    VideoDispatcher(std::string mjpeg_url, int fps, int frame_pool_size) : framePool(frame_pool_size)
     {
       this->active = true;
       this->latestFrameNumber = -1;
@@ -35,8 +37,8 @@ class VideoDispatcher
       if (latestFrameNumber == lastFrameRead)
         return -1;
       
-      frame->create(latestFrame.size(), latestFrame.type());
-      latestFrame.copyTo(*frame);
+      // Shares the pooled buffer.  It won't be reused until the caller releases it
+      *frame = latestFrame;
       
       this->lastFrameRead = this->latestFrameNumber;
       
@@ -49,7 +51,7 @@ class VideoDispatcher
     
     void setLatestFrame(cv::Mat frame)
     {      
-      frame.copyTo(this->latestFrame);
+      this->latestFrame = frame;
       this->latestRegionsOfInterest = calculateRegionsOfInterest(&this->latestFrame);
       
       this->latestFrameNumber++;
@@ -83,6 +85,8 @@ class VideoDispatcher
     int fps;
     tthread::mutex mMutex;
     
+    FramePool framePool;
+    
   private:
     cv::Mat latestFrame;
     std::vector<cv::Rect> latestRegionsOfInterest;
@@ -95,19 +99,26 @@ class VideoBuffer
     VideoBuffer();
     virtual ~VideoBuffer();
 
-    void connect(std::string mjpeg_url, int fps);
+    // frame_pool_size is the most frames that may be decoded into pooled buffers at once.  It should
+    // cover every frame the caller holds on to (queued or being analyzed), plus two for the
+    // buffer's newest frame and the one being decoded.  Frames beyond it are allocated individually
+    void connect(std::string mjpeg_url, int fps, int frame_pool_size = DEFAULT_FRAME_POOL_SIZE);
     
 
     // If a new frame is available, the function sets "frame" to it and returns the frame number
     // If no frames are available, or the latest has already been grabbed, returns -1.
     // regionsOfInterest is set to a list of good regions to check for license plates.  Default is one rectangle for the entire frame.
+    // The returned frame shares its buffer with the video buffer's frame pool, so it must be
+    // treated as read-only.  Copy it first if it needs to be modified.
     int getLatestFrame(cv::Mat* frame, std::vector<cv::Rect>& regionsOfInterest);
 
+    FramePoolStats getFramePoolStats();
+
     void disconnect();
     
   protected:
   
-    virtual VideoDispatcher* createDispatcher(std::string mjpeg_url, int fps);
+    virtual VideoDispatcher* createDispatcher(std::string mjpeg_url, int fps, int frame_pool_size);
     
   private:
     